@@ -0,0 +1,440 @@
+/*
+  Copyright 2013 Mats Sjöberg
+  
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+  License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  Headless benchmark: replays a directory of recorded pump.io JSON
+  responses through parseJson(), the activity streams model and the
+  collection widgets, and reports time, throughput, allocations and
+  resident memory for each stage.
+*/
+
+#include <QApplication>
+#include <QTabWidget>
+#include <QScrollBar>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QDir>
+#include <QFile>
+#include <QSet>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+#include "json.h"
+#include "util.h"
+#include "qactivitystreams.h"
+#include "collectionwidget.h"
+#include "filedownloader.h"
+#include "pumpa_defines.h"
+#include "trafficrecorder.h"
+
+//------------------------------------------------------------------------------
+// Allocation counting
+
+static qulonglong s_allocs = 0;
+static qulonglong s_allocBytes = 0;
+
+#ifdef __GLIBC__
+
+// With glibc we can interpose malloc itself, which also catches
+// Qt's container allocations that don't go through operator new.
+
+extern "C" {
+  void* __libc_malloc(size_t size);
+  void* __libc_calloc(size_t n, size_t size);
+  void* __libc_realloc(void* ptr, size_t size);
+
+  void* malloc(size_t size) __THROW {
+    s_allocs++;
+    s_allocBytes += size;
+    return __libc_malloc(size);
+  }
+
+  void* calloc(size_t n, size_t size) __THROW {
+    s_allocs++;
+    s_allocBytes += n*size;
+    return __libc_calloc(n, size);
+  }
+
+  void* realloc(void* ptr, size_t size) __THROW {
+    s_allocs++;
+    s_allocBytes += size;
+    return __libc_realloc(ptr, size);
+  }
+}
+
+#else
+
+// Dynamic exception specifications are gone in C++17, but the Qt 4
+// build is still pre-C++11 and wants them to match <new>.
+#if __cplusplus >= 201103L
+#define BENCH_NEW_THROW
+#define BENCH_DELETE_THROW noexcept
+#else
+#define BENCH_NEW_THROW throw(std::bad_alloc)
+#define BENCH_DELETE_THROW throw()
+#endif
+
+void* operator new(size_t size) BENCH_NEW_THROW {
+  s_allocs++;
+  s_allocBytes += size;
+  void* p = malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t size) BENCH_NEW_THROW {
+  return operator new(size);
+}
+
+void operator delete(void* p) BENCH_DELETE_THROW { free(p); }
+void operator delete[](void* p) BENCH_DELETE_THROW { free(p); }
+
+#endif
+
+//------------------------------------------------------------------------------
+
+struct StageStats {
+  StageStats() : nsecs(0), allocs(0), allocBytes(0), items(0), bytes(0),
+                 rss(0) {}
+
+  qint64 nsecs;
+  qulonglong allocs;
+  qulonglong allocBytes;
+  qint64 items;
+  qint64 bytes;
+  long rss;
+};
+
+//------------------------------------------------------------------------------
+
+class StageMeter {
+public:
+  StageMeter(StageStats& stats) : m_stats(stats) {
+    m_allocs = s_allocs;
+    m_allocBytes = s_allocBytes;
+    m_timer.start();
+  }
+
+  ~StageMeter() {
+    m_stats.nsecs += m_timer.nsecsElapsed();
+    m_stats.allocs += s_allocs - m_allocs;
+    m_stats.allocBytes += s_allocBytes - m_allocBytes;
+    m_stats.rss = qMax(m_stats.rss, getCurrentRSS());
+  }
+
+private:
+  StageStats& m_stats;
+  QElapsedTimer m_timer;
+  qulonglong m_allocs;
+  qulonglong m_allocBytes;
+};
+
+//------------------------------------------------------------------------------
+
+struct Response {
+  Response() : responseId(-1) {}
+
+  QString fileName;
+  int responseId; // -1 if not recorded
+  QByteArray data;
+  QVariantMap json;
+  JsonFingerprints fingerprints;
+};
+
+//------------------------------------------------------------------------------
+
+static bool readResponse(const QDir& dir, Response& r) {
+  QFile fp(dir.filePath(r.fileName));
+  if (!fp.open(QIODevice::ReadOnly)) {
+    fprintf(stderr, "Unable to read %s\n", qPrintable(fp.fileName()));
+    return false;
+  }
+  r.data = fp.readAll();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+/*
+  Reads the responses in the order given by an index.txt written by
+  pumpa -r, skipping failed requests and downloaded files. Without an
+  index, all *.json files are read in alphabetical order.
+*/
+static bool loadResponses(QString dirName, QList<Response>& responses) {
+  QDir dir(dirName);
+  if (!dir.exists()) {
+    fprintf(stderr, "No such directory: %s\n", qPrintable(dirName));
+    return false;
+  }
+
+  QFile index(dir.filePath(TrafficRecorder::IndexFile));
+  if (index.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    while (!index.atEnd()) {
+      QString line = QString::fromUtf8(index.readLine()).trimmed();
+      if (line.isEmpty() || line.startsWith('#'))
+        continue;
+
+      // file, response_id, method, error, bytes, msecs, endpoint
+      QStringList fields = line.split('\t');
+      if (fields.count() < 7) {
+        fprintf(stderr, "Malformed line in %s: %s\n",
+                qPrintable(index.fileName()), qPrintable(line));
+        return false;
+      }
+      if (!fields[0].endsWith(".json") || fields[3] != "0")
+        continue;
+
+      Response r;
+      r.fileName = fields[0];
+      r.responseId = fields[1].toInt();
+      if (!readResponse(dir, r))
+        return false;
+      responses.append(r);
+    }
+  } else {
+    QStringList files = dir.entryList(QStringList("*.json"), QDir::Files,
+                                      QDir::Name);
+    for (int i=0; i<files.count(); ++i) {
+      Response r;
+      r.fileName = files[i];
+      if (!readResponse(dir, r))
+        return false;
+      responses.append(r);
+    }
+  }
+
+  if (responses.isEmpty()) {
+    fprintf(stderr, "No responses found in %s\n", qPrintable(dirName));
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+static int guessResponseId(const QVariantMap& json) {
+  if (json.contains("items")) {
+    QVariantList items = json["items"].toList();
+    if (items.isEmpty() || items[0].toMap().contains("verb"))
+      return QAS_COLLECTION;
+    return QAS_OBJECTLIST;
+  }
+  if (json.contains("verb"))
+    return QAS_ACTIVITY;
+  if (json.contains("id"))
+    return QAS_OBJECT;
+  return QAS_NULL;
+}
+
+//------------------------------------------------------------------------------
+
+/*
+  Feeds one response to the model the same way as
+  PumpApp::onAuthorizedRequestReady() does, and returns the number of
+  items in it. The URLs of any collections are added to endpoints.
+*/
+static int updateModel(const Response& r, QObject* parent,
+                       QStringList& endpoints) {
+  const QVariantMap& json = r.json;
+  int id = r.responseId >= 0 ? r.responseId : guessResponseId(json);
+
+  switch (id & 0xFF) {
+  case QAS_COLLECTION: {
+    QASCollection* coll = QASCollection::getCollection(json, parent, id);
+    if (!endpoints.contains(coll->url()))
+      endpoints << coll->url();
+    return coll->size();
+  }
+  case QAS_ACTIVITY:
+    QASActivity::getActivity(json, parent);
+    return 1;
+  case QAS_OBJECTLIST:
+    return QASObjectList::getObjectList(json, parent, id)->size();
+  case QAS_OBJECT:
+    QASObject::getObject(json, parent);
+    return 1;
+  case QAS_ACTORLIST:
+    return QASActorList::getActorList(json, parent)->size();
+  case QAS_SELF_PROFILE:
+    QASActor::getActor(json["profile"].toMap(), parent);
+    return 1;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+
+static void printStage(QString name, const StageStats& s, int repeat) {
+  double secs = s.nsecs / 1e9;
+  double ms = s.nsecs / 1e6 / repeat;
+  double itemsPerSec = secs > 0 ? s.items / secs : 0;
+  double mbPerSec = secs > 0 ? s.bytes / secs / 1048576.0 : 0;
+
+  printf("%-8s %10.2f %12.0f %8.2f %12llu %10.2f %8.1f\n",
+         qPrintable(name), ms, itemsPerSec, mbPerSec,
+         s.allocs / repeat, s.allocBytes / 1048576.0 / repeat,
+         s.rss / 1048576.0);
+}
+
+//------------------------------------------------------------------------------
+
+static int usage() {
+  fprintf(stderr, "Usage: pumpa-bench [-n repeat] directory\n\n"
+          "Replays the responses recorded with pumpa -r in directory, or\n"
+          "if there is no index.txt, all *.json files in it.\n");
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+#ifdef QT5
+  if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+#endif
+  QApplication app(argc, argv);
+
+  int repeat = 1;
+  QString dirName;
+  QStringList args = app.arguments();
+  for (int i=1; i<args.count(); ++i) {
+    if (args[i] == "-n" && i+1 < args.count()) {
+      repeat = args[++i].toInt();
+      if (repeat < 1)
+        return usage();
+    } else if (dirName.isEmpty() && !args[i].startsWith('-')) {
+      dirName = args[i];
+    } else {
+      return usage();
+    }
+  }
+  if (dirName.isEmpty())
+    return usage();
+
+  QList<Response> responses;
+  if (!loadResponses(dirName, responses))
+    return 1;
+
+  // Never go to the network for avatars or images
+  FileDownloader::setOffline(true);
+
+  // ASWidget expects to be three levels down from the object owning
+  // the model, like in a tab of the main window.
+  QWidget host;
+  QTabWidget* tabs = new QTabWidget(&host);
+  host.show();
+
+  // Actors are never removed from the cache, so they need to outlive
+  // the repeats.
+  QObject actorParent;
+
+  StageStats parse, model, widgets, scroll;
+  qint64 widgetCount = 0;
+  long rssStart = getCurrentRSS();
+
+  for (int n=0; n<repeat; ++n) {
+    {
+      StageMeter meter(parse);
+      for (int i=0; i<responses.count(); ++i) {
+        Response& r = responses[i];
+        r.json = parseJson(r.data);
+        r.fingerprints.clear();
+        collectJsonFingerprints(r.json, r.fingerprints);
+        parse.bytes += r.data.size();
+        parse.items++;
+      }
+    }
+
+    QStringList endpoints;
+    {
+      StageMeter meter(model);
+      for (int i=0; i<responses.count(); ++i) {
+        const Response& r = responses[i];
+        model.bytes += r.data.size();
+
+        QASAbstractObject::beginResponse(&r.fingerprints);
+        model.items += updateModel(r, &actorParent, endpoints);
+        QASAbstractObject::endResponse();
+      }
+    }
+
+    {
+      StageMeter meter(widgets);
+      for (int i=0; i<endpoints.count(); ++i) {
+        CollectionWidget* w = new CollectionWidget(&host);
+        tabs->addTab(w, endpoints[i]);
+        w->setEndpoint(endpoints[i]);
+        QMetaObject::invokeMethod(w, "update", Qt::DirectConnection);
+        while (w->updatePending())
+          app.processEvents();
+        widgets.items += w->count();
+      }
+      app.processEvents();
+    }
+    widgetCount += host.findChildren<QWidget*>().count();
+
+    // Switch to each tab and page through it, as a user reading the
+    // timelines would. Nothing but the scroll position changes, so
+    // this should not need to lay out the rows again.
+    {
+      StageMeter meter(scroll);
+      for (int i=0; i<tabs->count(); ++i) {
+        tabs->setCurrentIndex(i);
+        app.processEvents();
+        scroll.items++;
+
+        QScrollBar* sb =
+          qobject_cast<QAbstractScrollArea*>(tabs->widget(i))->
+          verticalScrollBar();
+        while (sb->value() < sb->maximum()) {
+          sb->setValue(sb->value() + qMax(sb->pageStep(), 1));
+          app.processEvents();
+          scroll.items++;
+        }
+      }
+    }
+
+    while (tabs->count()) {
+      QWidget* w = tabs->widget(0);
+      tabs->removeTab(0);
+      delete w;
+    }
+    resetActivityStreams();
+  }
+
+  printf("%d responses, %d repeats\n\n", responses.count(), repeat);
+  printf("%-8s %10s %12s %8s %12s %10s %8s\n", "stage", "ms/run",
+         "items/s", "MB/s", "allocs/run", "MB/run", "RSS MB");
+  printStage("parse", parse, repeat);
+  printStage("model", model, repeat);
+  printStage("widgets", widgets, repeat);
+  printStage("scroll", scroll, repeat);
+  if (widgets.items)
+    printf("\n%.1f QWidgets per item\n", double(widgetCount) / widgets.items);
+  if (scroll.items)
+    printf("%.3f ms per scroll step or tab switch\n",
+           scroll.nsecs / 1e6 / scroll.items);
+  printf("\nRSS at start %.1f MB, peak %.1f MB\n",
+         rssStart / 1048576.0, getMaxRSS() / 1024.0);
+
+  return 0;
+}
@@ -0,0 +1,304 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+  Micro-benchmarks of the functions that run for every item in a
+  timeline. Each benchmark has small and large inputs where that
+  makes a difference.
+*/
+
+#include <QtTest>
+#include <QApplication>
+
+#include "qactivitystreams.h"
+#include "fullobjectwidget.h"
+#include "filedownloader.h"
+#include "pumpapp.h"
+#include "util.h"
+#include "kqoauthutils.h"
+#include "kqoauthrequest_p.h"
+#include "oauthexample.h"
+
+//------------------------------------------------------------------------------
+
+// Gives access to the protected QASAbstractObject::updateVar()s.
+class UpdateVarObject : public QASAbstractObject {
+public:
+  UpdateVarObject() : QASAbstractObject(QAS_NULL, NULL) {}
+
+  static void update(const QVariantMap& json, QString& s, bool& b,
+                     qulonglong& n, QDateTime& dt, QString& nested,
+                     bool& changed) {
+    updateVar(json, s, "content", changed);
+    updateVar(json, b, "liked", changed);
+    updateVar(json, n, "totalItems", changed, true);
+    updateVar(json, dt, "published", changed);
+    updateVar(json, nested, "links", "self", "href", changed);
+  }
+};
+
+//------------------------------------------------------------------------------
+
+static QString sampleText(int paragraphs) {
+  QString text;
+  for (int i=0; i<paragraphs; i++)
+    text += QString("<p>Paragraph %1 with <b>bold</b>, <i>italic</i> and a "
+                    "link to <a href=\"http://example.com/some/rather/long/"
+                    "path/%1\">http://example.com/some/rather/long/path/%1"
+                    "</a>. Also a plain url: https://pump.io/%1 and an "
+                    "<img src=\"http://example.com/%1.png\" /> image.</p>").
+      arg(i);
+  return text;
+}
+
+//------------------------------------------------------------------------------
+
+static QString sampleMarkdown(int paragraphs) {
+  QString text;
+  for (int i=0; i<paragraphs; i++)
+    text += QString("Hello *world* number %1, see [a link](http://foo.bar/%1)"
+                    " or http://saz.im/%1 and `some code`.\n\n"
+                    "> quoted text %1\n\n").arg(i);
+  return text;
+}
+
+//------------------------------------------------------------------------------
+
+class PumpaMicroBench : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+
+  void updateVar();
+  void parseTime();
+  void urlToPath_data();
+  void urlToPath();
+  void markDown_data();
+  void markDown();
+  void addTextMarkup_data();
+  void addTextMarkup();
+  void linkifyUrls_data();
+  void linkifyUrls();
+  void processText_data();
+  void processText();
+  void relativeFuzzyTime();
+  void oauthBaseString();
+  void oauthSignature();
+  void oauthSignatureNewKey();
+
+private:
+  QObject* m_parent;
+  FullObjectWidget* m_widget;
+};
+
+//------------------------------------------------------------------------------
+
+void PumpaMicroBench::initTestCase() {
+  FileDownloader::setOffline(true);
+
+  m_parent = new QObject;
+  QVariantMap json;
+  json["id"] = "http://example.com/api/note/1";
+  json["objectType"] = "note";
+  json["content"] = "Hello";
+  QASObject* obj = QASObject::getObject(json, m_parent);
+  m_widget = new FullObjectWidget(obj);
+}
+
+//------------------------------------------------------------------------------
+
+void PumpaMicroBench::cleanupTestCase() {
+  delete m_widget;
+  resetActivityStreams();
+  delete m_parent;
+}
+
+//------------------------------------------------------------------------------
+
+void PumpaMicroBench::updateVar() {
+  QVariantMap self;
+  self["href"] = "http://example.com/api/note/1";
+  QVariantMap links;
+  links["self"] = self;
+
+  QVariantMap json;
+  json["content"] = sampleText(1);
+  json["liked"] = true;
+  json["totalItems"] = 42;
+  json["published"] = "2013-05-28T16:43:06Z";
+  json["links"] = links;
+
+  QString s, nested;
+  bool b = false, changed = false;
+  qulonglong n = 0;
+  QDateTime dt;
+
+  QBENCHMARK {
+    UpdateVarObject::update(json, s, b, n, dt, nested, changed);
+  }
+  QVERIFY(changed);
+}
+
+//------------------------------------------------------------------------------
+
+void PumpaMicroBench::parseTime() {
+  QString str("2013-05-28T16:43:06Z");
+  QDateTime dt;
+  QBENCHMARK {
+    dt = ::parseTime(str);
+  }
+  QVERIFY(dt.isValid());
+}
+
+//------------------------------------------------------------------------------
+
+void PumpaMicroBench::urlToPath_data() {
+  QTest::addColumn<QString>("url");
+  QTest::newRow("avatar") << "https://example.com/uploads/user/2013/5/28/"
+    "avatar_thumb.png";
+  QTest::newRow("proxy") << "https://example.com/api/proxy/"
+    "aKCKAmmpSD3aIhRrtF2d2Q";
+}
+
+void PumpaMicroBench::urlToPath() {
+  QFETCH(QString, url);
+  QString path;
+  QBENCHMARK {
+    path = FileDownloader::urlToPath(url);
+  }
+  QVERIFY(!path.isEmpty());
+}
+
+//------------------------------------------------------------------------------
+
+static void addSizes(bool markdown) {
+  QTest::addColumn<QString>("text");
+  QTest::newRow("short") << (markdown ? sampleMarkdown(1) : sampleText(1));
+  QTest::newRow("long") << (markdown ? sampleMarkdown(20) : sampleText(20));
+}
+
+void PumpaMicroBench::markDown_data() { addSizes(true); }
+
+void PumpaMicroBench::markDown() {
+  QFETCH(QString, text);
+  QString out;
+  QBENCHMARK {
+    out = ::markDown(text);
+  }
+  QVERIFY(!out.isEmpty());
+}
+
+//------------------------------------------------------------------------------
+
+void PumpaMicroBench::addTextMarkup_data() { addSizes(true); }
+
+void PumpaMicroBench::addTextMarkup() {
+  QFETCH(QString, text);
+  QString out;
+  QBENCHMARK {
+    out = PumpApp::addTextMarkup(text);
+  }
+  QVERIFY(!out.isEmpty());
+}
+
+//------------------------------------------------------------------------------
+
+void PumpaMicroBench::linkifyUrls_data() { addSizes(false); }
+
+void PumpaMicroBench::linkifyUrls() {
+  QFETCH(QString, text);
+  QString out;
+  QBENCHMARK {
+    out = ::linkifyUrls(text);
+  }
+  QVERIFY(!out.isEmpty());
+}
+
+//------------------------------------------------------------------------------
+
+void PumpaMicroBench::processText_data() { addSizes(false); }
+
+void PumpaMicroBench::processText() {
+  QFETCH(QString, text);
+  QString out;
+  QBENCHMARK {
+    out = m_widget->processText(text);
+  }
+  QVERIFY(!out.isEmpty());
+}
+
+//------------------------------------------------------------------------------
+
+void PumpaMicroBench::relativeFuzzyTime() {
+  QDateTime dt = QDateTime::currentDateTime().addSecs(-3*3600);
+  QString out;
+  QBENCHMARK {
+    out = ::relativeFuzzyTime(dt);
+  }
+  QVERIFY(!out.isEmpty());
+}
+
+//------------------------------------------------------------------------------
+
+void PumpaMicroBench::oauthBaseString() {
+  KQOAuthRequestPrivate d;
+  initOAuthExample(d);
+  QByteArray base;
+  QBENCHMARK {
+    base = d.requestBaseString();
+  }
+  QVERIFY(base.startsWith("GET&"));
+}
+
+void PumpaMicroBench::oauthSignature() {
+  KQOAuthRequestPrivate d;
+  initOAuthExample(d);
+  QString sig;
+  QBENCHMARK {
+    sig = d.oauthSignature();
+  }
+  QCOMPARE(sig, QString("tR3%2BTy81lMeYAr%2FFid0kMTYa%2FWM%3D"));
+}
+
+// Signing with a key that isn't cached, as for the first request.
+void PumpaMicroBench::oauthSignatureNewKey() {
+  QString sig;
+  QBENCHMARK {
+    sig = KQOAuthUtils::hmac_sha1("GET&http%3A%2F%2Fexample.com&a%3Db",
+                                  "consumer&token");
+  }
+  QVERIFY(!sig.isEmpty());
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+#ifdef QT5
+  if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+#endif
+  QApplication app(argc, argv);
+  PumpaMicroBench bench;
+  return QTest::qExec(&bench, argc, argv);
+}
+
+#include "microbench.moc"
@@ -0,0 +1,38 @@
+# -*- mode: makefile -*-
+######################################################################
+#  Copyright 2013 Mats Sjöberg
+#  
+#  This file is part of the Pumpa programme.
+#
+#  Pumpa is free software: you can redistribute it and/or modify it
+#  under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  Pumpa is distributed in the hope that it will be useful, but
+#  WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+#  General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+######################################################################
+
+# QTestLib micro-benchmarks of the hot functions. Build with:
+#
+#   cd bench/micro && qmake && make
+#
+# and see the Benchmarking section of the README for how to run it.
+
+TEMPLATE = app
+TARGET = pumpa-microbench
+OBJECTS_DIR = obj
+
+CONFIG += release
+CONFIG -= debug
+
+QT += testlib
+
+include(../../pumpa.pri)
+
+SOURCES += microbench.cpp
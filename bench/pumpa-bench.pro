@@ -0,0 +1,40 @@
+# -*- mode: makefile -*-
+######################################################################
+#  Copyright 2013 Mats Sjöberg
+#  
+#  This file is part of the Pumpa programme.
+#
+#  Pumpa is free software: you can redistribute it and/or modify it
+#  under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  Pumpa is distributed in the hope that it will be useful, but
+#  WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+#  General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+######################################################################
+
+# Headless benchmark that replays recorded server responses through
+# the JSON parser, the model and the widgets. Build with:
+#
+#   cd bench && qmake && make
+#
+# and see the Benchmarking section of the README for how to run it.
+
+TEMPLATE = app
+TARGET = pumpa-bench
+OBJECTS_DIR = obj
+
+CONFIG += release
+CONFIG -= debug
+
+# getMaxRSS() and getCurrentRSS() only report with DEBUG_MEMORY
+DEFINES += DEBUG_MEMORY
+
+include(../pumpa.pri)
+
+SOURCES += benchmain.cpp
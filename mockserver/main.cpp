@@ -0,0 +1,118 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QHostAddress>
+
+#include <stdio.h>
+
+#include "mockserver.h"
+#include "mockdata.h"
+
+//------------------------------------------------------------------------------
+
+static int usage() {
+  fprintf(stderr,
+          "Usage: pumpa-mockserver [options]\n\n"
+          "  --port N          port to listen on (8080)\n"
+          "  --user NAME       nickname of the user (tester)\n"
+          "  --items N         number of activities in the timeline (1000)\n"
+          "  --page-size N     items per page when not asked for (20)\n"
+          "  --latency MS      delay before each response (0)\n"
+          "  --bandwidth KB    bytes per second in KB, 0 for unlimited (0)\n"
+          "  --error-rate P    fraction of requests that fail, 0-1 (0)\n"
+          "  --any-host        listen on all interfaces, not only localhost\n"
+          "  --verbose         print every request\n");
+  return 1;
+}
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+  QCoreApplication app(argc, argv);
+
+  int port = 8080;
+  QString user = "tester";
+  int items = 1000;
+  int pageSize = 20;
+  int latency = 0;
+  int bandwidth = 0;
+  double errorRate = 0.0;
+  bool anyHost = false;
+  bool verbose = false;
+
+  QStringList args = app.arguments();
+  for (int i=1; i<args.size(); i++) {
+    QString arg = args[i];
+    bool hasValue = (i+1 < args.size());
+    bool ok = true;
+
+    if (arg == "--port" && hasValue)
+      port = args[++i].toInt(&ok);
+    else if (arg == "--user" && hasValue)
+      user = args[++i];
+    else if (arg == "--items" && hasValue)
+      items = args[++i].toInt(&ok);
+    else if (arg == "--page-size" && hasValue)
+      pageSize = args[++i].toInt(&ok);
+    else if (arg == "--latency" && hasValue)
+      latency = args[++i].toInt(&ok);
+    else if (arg == "--bandwidth" && hasValue)
+      bandwidth = args[++i].toInt(&ok) * 1024;
+    else if (arg == "--error-rate" && hasValue)
+      errorRate = args[++i].toDouble(&ok);
+    else if (arg == "--any-host")
+      anyHost = true;
+    else if (arg == "--verbose")
+      verbose = true;
+    else
+      return usage();
+
+    if (!ok || port <= 0 || items < 0 || pageSize <= 0 || latency < 0 ||
+        bandwidth < 0 || errorRate < 0.0 || errorRate > 1.0)
+      return usage();
+  }
+
+  QString baseUrl = QString("http://localhost:%1").arg(port);
+  MockData data(baseUrl, user, items, pageSize);
+
+  // The same sequence of simulated errors in every run
+  qsrand(1);
+
+  MockServer server(&data);
+  server.setLatency(latency);
+  server.setBandwidth(bandwidth);
+  server.setErrorRate(errorRate);
+  server.setVerbose(verbose);
+
+  if (!server.listen(anyHost ? QHostAddress::Any : QHostAddress::LocalHost,
+                     port)) {
+    fprintf(stderr, "Unable to listen on port %d: %s\n", port,
+            qPrintable(server.errorString()));
+    return 1;
+  }
+
+  printf("Mock pump.io server running at %s\n"
+         "Log in with pumpa as %s@localhost:%d, the verifier is "
+         "mock-verifier.\n", qPrintable(baseUrl), qPrintable(user), port);
+  fflush(stdout);
+
+  return app.exec();
+}
@@ -0,0 +1,655 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "mockdata.h"
+
+#include <QUrl>
+#include <QtAlgorithms>
+
+#include <limits.h>
+
+//------------------------------------------------------------------------------
+
+// Authors of the generated activities, number 0 is the user
+static const int NumPeople = 50;
+
+static const int NoKey = INT_MIN;
+
+static const char* s_words[] = {
+  "pump", "stream", "federated", "social", "network", "note", "image",
+  "comment", "server", "client", "free", "software", "today", "weather",
+  "coffee", "train", "late", "again", "music", "new", "release", "bug",
+  "patch", "review", "merge", "cat", "garden", "rain", "summer", "winter",
+  "book", "reading", "writing", "code", "Qt", "fast", "slow", "timeline",
+  "friends", "weekend", "conference", "talk", "slides", "photo", "walk",
+  "forest", "lake", "city", "night", "morning", NULL };
+
+//------------------------------------------------------------------------------
+
+static int nextRandom(quint32& state) {
+  state = state*1103515245 + 12345;
+  return (state >> 16) & 0x7fff;
+}
+
+//------------------------------------------------------------------------------
+
+static int actorOf(int i) { return (i*7) % NumPeople; }
+
+//------------------------------------------------------------------------------
+
+MockData::MockData(QString baseUrl, QString userName, int items,
+                   int pageSize) :
+  m_baseUrl(baseUrl),
+  m_userName(userName),
+  m_items(items),
+  m_pageSize(pageSize)
+{
+  m_host = QUrl(baseUrl).host();
+  int port = QUrl(baseUrl).port();
+  if (port > 0)
+    m_host += QString(":%1").arg(port);
+
+  // Whole seconds, to keep the timestamps in the plain format
+  m_startTime = QDateTime::currentDateTime().toUTC();
+  m_startTime.setTime(QTime(m_startTime.time().hour(),
+                            m_startTime.time().minute(),
+                            m_startTime.time().second()));
+}
+
+//------------------------------------------------------------------------------
+
+int MockData::personNumber(QString nickname) const {
+  if (nickname == m_userName)
+    return 0;
+  if (!nickname.startsWith("user"))
+    return -1;
+
+  bool ok = false;
+  int n = nickname.mid(4).toInt(&ok);
+  return ok && n > 0 ? n : -1;
+}
+
+//------------------------------------------------------------------------------
+
+QString MockData::timeString(int i) const {
+  return m_startTime.addSecs(-90*i).toString("yyyy-MM-dd'T'hh:mm:ss'Z'");
+}
+
+//------------------------------------------------------------------------------
+
+QString MockData::content(int seed) const {
+  quint32 state = seed;
+  int numWords = 0;
+  while (s_words[numWords])
+    numWords++;
+
+  int sentences = 1 + nextRandom(state) % 6;
+  if (seed % 17 == 0)
+    sentences = 20;
+
+  QString text = "<p>";
+  for (int s=0; s<sentences; s++) {
+    int words = 5 + nextRandom(state) % 11;
+    for (int w=0; w<words; w++) {
+      QString word = s_words[nextRandom(state) % numWords];
+      if (w == 0)
+        word[0] = word[0].toUpper();
+
+      int r = nextRandom(state) % 40;
+      if (r == 0)
+        word = "<b>" + word + "</b>";
+      else if (r == 1)
+        word = QString("<a href=\"http://example.com/%1/%2\">%2</a>").
+          arg(seed).arg(word);
+
+      text += (w ? " " : "") + word;
+    }
+    text += ". ";
+    if (s % 3 == 2 && s+1 < sentences)
+      text += "</p><p>";
+  }
+  return text.trimmed() + "</p>";
+}
+
+//------------------------------------------------------------------------------
+
+QVariantMap MockData::person(int n) const {
+  QString nick = n == 0 ? m_userName : QString("user%1").arg(n);
+
+  QVariantMap image;
+  image["url"] = QString("%1/images/avatar-%2.png").arg(m_baseUrl).arg(n % 8);
+  image["width"] = 96;
+  image["height"] = 96;
+
+  QVariantMap self;
+  self["href"] = QString("%1/api/user/%2/profile").arg(m_baseUrl).arg(nick);
+  QVariantMap links;
+  links["self"] = self;
+
+  QVariantMap pumpIo;
+  pumpIo["followed"] = (n != 0 && n % 2 == 0);
+
+  QVariantMap obj;
+  obj["id"] = QString("acct:%1@%2").arg(nick).arg(m_host);
+  obj["objectType"] = "person";
+  obj["preferredUsername"] = nick;
+  obj["displayName"] = n == 0 ? nick : QString("Mock User %1").arg(n);
+  obj["url"] = m_baseUrl + "/" + nick;
+  obj["summary"] = content(n*13 + 1);
+  obj["image"] = image;
+  obj["links"] = links;
+  obj["pump_io"] = pumpIo;
+  return obj;
+}
+
+//------------------------------------------------------------------------------
+
+QVariantMap MockData::profile(int n) const {
+  return person(n);
+}
+
+//------------------------------------------------------------------------------
+
+QVariantMap MockData::selfProfile() const {
+  QVariantMap json;
+  json["nickname"] = m_userName;
+  json["profile"] = person(0);
+  return json;
+}
+
+//------------------------------------------------------------------------------
+
+QVariantMap MockData::collection(QString url, int totalItems,
+                                 const QVariantList& items) const {
+  QVariantMap json;
+  json["url"] = url;
+  json["totalItems"] = totalItems;
+  json["items"] = items;
+  return json;
+}
+
+//------------------------------------------------------------------------------
+
+QVariantMap MockData::note(int n, bool full) const {
+  QString id = QString("%1/api/note/%2").arg(m_baseUrl).arg(n);
+  QVariantMap author = person(actorOf(n));
+
+  QVariantMap self;
+  self["href"] = id;
+  QVariantMap links;
+  links["self"] = self;
+
+  QVariantMap obj;
+  obj["id"] = id;
+  obj["objectType"] = n % 6 == 0 ? "image" : "note";
+  obj["author"] = author;
+  obj["content"] = content(n);
+  obj["published"] = timeString(n);
+  obj["updated"] = timeString(n);
+  obj["url"] = QString("%1/note/%2").arg(author["url"].toString()).arg(n);
+  obj["links"] = links;
+
+  if (n % 6 == 0) {
+    QVariantMap image;
+    image["url"] = QString("%1/images/photo-%2.png").arg(m_baseUrl).arg(n % 4);
+    image["width"] = 320;
+    image["height"] = 240;
+    QVariantMap fullImage;
+    fullImage["url"] = QString("%1/images/photo-%2-full.png").
+      arg(m_baseUrl).arg(n % 4);
+
+    obj["displayName"] = QString("Photo %1").arg(n);
+    obj["image"] = image;
+    obj["fullImage"] = fullImage;
+  }
+
+  if (full) {
+    QVariantList replies, likes, shares;
+    for (int k=0; k<n % 3; k++)
+      replies << comment(n, k);
+    for (int k=0; k<n % 5; k++)
+      likes << person((n+k+1) % NumPeople);
+    if (n % 4 == 0)
+      shares << person((n+7) % NumPeople);
+
+    obj["replies"] = collection(id + "/replies", replies.size(), replies);
+    obj["likes"] = collection(id + "/likes", likes.size(), likes);
+    obj["shares"] = collection(id + "/shares", shares.size(), shares);
+    obj["liked"] = false;
+  }
+  return obj;
+}
+
+//------------------------------------------------------------------------------
+
+// Comment number k on note n, or if k < 0 a comment in the timeline
+// that replies to note n+1.
+QVariantMap MockData::comment(int n, int k) const {
+  QVariantMap obj;
+  QVariantMap inReplyTo;
+
+  if (k < 0) {
+    obj["id"] = QString("%1/api/comment/%2").arg(m_baseUrl).arg(n);
+    obj["author"] = person(actorOf(n));
+    obj["content"] = content(n*31 + 7);
+    obj["published"] = timeString(n);
+    inReplyTo["id"] = QString("%1/api/note/%2").arg(m_baseUrl).arg(n+1);
+    inReplyTo["objectType"] = (n+1) % 6 == 0 ? "image" : "note";
+  } else {
+    obj["id"] = QString("%1/api/comment/%2-%3").arg(m_baseUrl).arg(n).arg(k);
+    obj["author"] = person((n+k+1) % NumPeople);
+    obj["content"] = content(n*17 + k);
+    obj["published"] = timeString(qMax(0, n-k-1));
+    inReplyTo["id"] = QString("%1/api/note/%2").arg(m_baseUrl).arg(n);
+    inReplyTo["objectType"] = n % 6 == 0 ? "image" : "note";
+  }
+
+  obj["objectType"] = "comment";
+  obj["updated"] = obj["published"];
+  obj["inReplyTo"] = inReplyTo;
+  return obj;
+}
+
+//------------------------------------------------------------------------------
+
+int MockData::verb(int i) const {
+  if (i % 13 == 12)
+    return Follow;
+  if (i % 10 == 3)
+    return Share;
+  if (i % 7 == 5)
+    return Like;
+  if (i % 4 == 1)
+    return Comment;
+  return Post;
+}
+
+//------------------------------------------------------------------------------
+
+bool MockData::isFeed(QString name) const {
+  return name == "major" || name == "minor" || name == "direct/major" ||
+    name == "direct/minor" || name == "feed" || name == "firehose";
+}
+
+//------------------------------------------------------------------------------
+
+bool MockData::inFeed(QString name, int i) const {
+  int v = verb(i);
+  bool major = (v == Post || v == Share);
+
+  if (name == "major")
+    return major;
+  if (name == "minor")
+    return !major;
+  if (name == "direct/major")
+    return major && i % 5 == 0;
+  if (name == "direct/minor")
+    return !major && i % 5 == 0;
+  if (name == "feed")
+    return actorOf(i) == 0;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+const QVector<int>& MockData::feedItems(QString name) {
+  QHash<QString, QVector<int> >::iterator it = m_feeds.find(name);
+  if (it != m_feeds.end())
+    return it.value();
+
+  QVector<int> items;
+  for (int i=0; i<m_items; i++)
+    if (inFeed(name, i))
+      items.append(i);
+
+  return m_feeds.insert(name, items).value();
+}
+
+//------------------------------------------------------------------------------
+
+QString MockData::activityId(int key) const {
+  if (key < 0)
+    return QString("%1/api/activity/posted-%2").arg(m_baseUrl).arg(-key-1);
+  return QString("%1/api/activity/%2").arg(m_baseUrl).arg(key);
+}
+
+//------------------------------------------------------------------------------
+
+int MockData::keyFromId(QString id) const {
+  QString prefix = m_baseUrl + "/api/activity/";
+  if (!id.startsWith(prefix))
+    return NoKey;
+  id = id.mid(prefix.length());
+
+  bool ok = false;
+  if (id.startsWith("posted-")) {
+    int k = id.mid(7).toInt(&ok);
+    return ok && k >= 0 && k < m_posted.size() ? -k-1 : NoKey;
+  }
+
+  int i = id.toInt(&ok);
+  return ok && i >= 0 && i < m_items ? i : NoKey;
+}
+
+//------------------------------------------------------------------------------
+
+QVariantMap MockData::activity(int key) const {
+  if (key < 0)
+    return m_posted[-key-1];
+
+  int i = key;
+  int v = verb(i);
+  QVariantMap actor = person(actorOf(i));
+
+  QVariantMap act;
+  act["id"] = activityId(i);
+  act["actor"] = actor;
+  act["published"] = timeString(i);
+  act["updated"] = timeString(i);
+
+  QVariantMap obj;
+  QString verbName, done, what;
+  switch (v) {
+  case Post:
+    verbName = "post";
+    done = "posted";
+    obj = note(i, true);
+    what = "a " + obj["objectType"].toString();
+    break;
+  case Comment:
+    verbName = "post";
+    done = "posted";
+    obj = comment(i, -1);
+    what = "a comment";
+    break;
+  case Share:
+    verbName = "share";
+    done = "shared";
+    obj = note(i+5, true);
+    what = "a note";
+    break;
+  case Like:
+    verbName = "favorite";
+    done = "favorited";
+    obj = note(i+3, false);
+    what = "a note";
+    break;
+  case Follow:
+    verbName = "follow";
+    done = "followed";
+    obj = person((i*3 + 1) % NumPeople);
+    what = obj["displayName"].toString();
+    break;
+  }
+
+  act["verb"] = verbName;
+  act["object"] = obj;
+  act["content"] = QString("%1 %2 %3").arg(actor["displayName"].toString()).
+    arg(done).arg(what);
+
+  QVariantMap generator;
+  generator["displayName"] = "Pumpa mock server";
+  act["generator"] = generator;
+
+  QVariantMap publicRecipient;
+  publicRecipient["id"] = "http://activityschema.org/collection/public";
+  publicRecipient["objectType"] = "collection";
+  act["to"] = QVariantList() << publicRecipient;
+
+  return act;
+}
+
+//------------------------------------------------------------------------------
+
+int MockData::pageSize(const QueryMap& query) const {
+  int count = query.value("count").toInt();
+  return count > 0 ? qMin(count, 200) : m_pageSize;
+}
+
+//------------------------------------------------------------------------------
+
+/*
+  Pages like pump.io: without parameters the newest items, with
+  before=ID the items older than ID and with since=ID the ones newer
+  than ID. The next link goes to older items and prev to newer.
+*/
+QVariantMap MockData::feed(QString name, const QueryMap& query) {
+  const QVector<int>& generated = feedItems(name);
+  bool withPosted = (name == "major" || name == "feed" || name == "firehose");
+  int numPosted = withPosted ? m_posted.size() : 0;
+  int total = numPosted + generated.size();
+  int count = pageSize(query);
+
+  // Position in the feed of the given activity id, or -1
+  QString ref = query.contains("before") ? query["before"] : query["since"];
+  int pos = -1;
+  if (!ref.isEmpty()) {
+    int key = keyFromId(ref);
+    if (key != NoKey && key < 0)
+      pos = withPosted ? numPosted + key : -1;
+    else if (key != NoKey)
+      pos = numPosted + (qLowerBound(generated.begin(), generated.end(), key)
+                         - generated.begin());
+  }
+
+  int start = 0, end = qMin(count, total);
+  if (query.contains("before")) {
+    start = pos < 0 ? total : pos + 1;
+    end = qMin(start + count, total);
+  } else if (query.contains("since")) {
+    end = pos < 0 ? 0 : pos;
+    start = qMax(0, end - count);
+  }
+
+  QVariantList items;
+  for (int p=start; p<end; p++)
+    items << activity(p < numPosted ? p - numPosted : generated[p-numPosted]);
+
+  QString url;
+  if (name == "firehose")
+    url = m_baseUrl + "/api/firehose";
+  else if (name == "feed")
+    url = m_baseUrl + "/api/user/" + m_userName + "/feed";
+  else
+    url = m_baseUrl + "/api/user/" + m_userName + "/inbox/" + name;
+
+  QVariantMap json = collection(url, total, items);
+  json["displayName"] = QString("Mock %1 feed").arg(name);
+
+  QVariantMap links;
+  if (!items.isEmpty()) {
+    QVariantMap prev;
+    prev["href"] = url + "?since=" +
+      QUrl::toPercentEncoding(items.first().toMap()["id"].toString());
+    links["prev"] = prev;
+  }
+  if (!items.isEmpty() && end < total) {
+    QVariantMap next;
+    next["href"] = url + "?before=" +
+      QUrl::toPercentEncoding(items.last().toMap()["id"].toString());
+    links["next"] = next;
+  }
+  json["links"] = links;
+
+  return json;
+}
+
+//------------------------------------------------------------------------------
+
+QVariantMap MockData::people(QString which, const QueryMap& query) const {
+  bool following = (which == "following");
+  int total = following ? NumPeople - 1 : qMax(1, m_items / 10);
+  int count = pageSize(query);
+  int offset = qBound(0, query.value("offset").toInt(), total);
+  int end = qMin(offset + count, total);
+
+  QVariantList items;
+  for (int i=offset; i<end; i++) {
+    QVariantMap p = person(i+1);
+    if (following) {
+      QVariantMap pumpIo;
+      pumpIo["followed"] = true;
+      p["pump_io"] = pumpIo;
+    }
+    items << p;
+  }
+
+  QString url = m_baseUrl + "/api/user/" + m_userName + "/" + which;
+  QVariantMap json = collection(url, total, items);
+  json["displayName"] = QString("Mock %1").arg(which);
+
+  QVariantMap links;
+  if (end < total) {
+    QVariantMap next;
+    next["href"] = QString("%1?offset=%2&count=%3").arg(url).arg(end).
+      arg(count);
+    links["next"] = next;
+  }
+  json["links"] = links;
+
+  return json;
+}
+
+//------------------------------------------------------------------------------
+
+QVariantMap MockData::object(QString path) const {
+  QString id = m_baseUrl + "/api/" + path;
+  if (m_postedObjects.contains(id))
+    return m_postedObjects[id];
+
+  QStringList parts = path.split('/');
+  if (parts.size() != 2)
+    return QVariantMap();
+
+  bool ok = false;
+  if (parts[0] == "note") {
+    int n = parts[1].toInt(&ok);
+    if (ok && n >= 0)
+      return note(n, true);
+  } else if (parts[0] == "comment") {
+    QStringList nk = parts[1].split('-');
+    int n = nk[0].toInt(&ok);
+    if (!ok || n < 0)
+      return QVariantMap();
+    if (nk.size() == 1)
+      return comment(n, -1);
+    int k = nk[1].toInt(&ok);
+    if (ok && k >= 0)
+      return comment(n, k);
+  }
+  return QVariantMap();
+}
+
+//------------------------------------------------------------------------------
+
+QVariantMap MockData::replies(QString path) const {
+  QVariantMap obj = object(path);
+  if (obj.isEmpty())
+    return obj;
+
+  QVariantMap replies = obj["replies"].toMap();
+  if (replies.isEmpty())
+    replies = collection(obj["id"].toString() + "/replies", 0,
+                         QVariantList());
+  return replies;
+}
+
+//------------------------------------------------------------------------------
+
+QVariantMap MockData::post(QVariantMap act) {
+  int k = m_posted.size();
+  QString now = QDateTime::currentDateTime().toUTC().
+    toString("yyyy-MM-dd'T'hh:mm:ss'Z'");
+  QString verbName = act["verb"].toString();
+
+  act["id"] = activityId(-k-1);
+  act["actor"] = person(0);
+  act["published"] = now;
+  act["updated"] = now;
+
+  QVariantMap obj = act["object"].toMap();
+  QString objId = obj["id"].toString();
+
+  if (verbName == "post" && objId.isEmpty()) {
+    QString type = obj["objectType"].toString();
+    objId = QString("%1/api/%2/posted-%3").arg(m_baseUrl).
+      arg(type.isEmpty() ? QString("note") : type).arg(k);
+    obj["id"] = objId;
+    obj["published"] = now;
+  }
+
+  if (m_postedObjects.contains(objId)) {
+    QVariantMap old = m_postedObjects[objId];
+    for (QVariantMap::const_iterator it = obj.constBegin();
+         it != obj.constEnd(); ++it)
+      old[it.key()] = it.value();
+    obj = old;
+  }
+
+  if (verbName == "post" || verbName == "update" || verbName == "delete") {
+    obj["author"] = person(0);
+    obj["updated"] = now;
+    if (verbName == "delete")
+      obj["deleted"] = now;
+    if (!objId.isEmpty())
+      m_postedObjects.insert(objId, obj);
+  }
+
+  act["object"] = obj;
+  m_posted.append(act);
+  return act;
+}
+
+//------------------------------------------------------------------------------
+
+QVariantMap MockData::upload(const QByteArray& data, QString contentType) {
+  QString ext = contentType.section('/', 1);
+  if (ext == "jpeg")
+    ext = "jpg";
+
+  QString name = QString("upload-%1.%2").arg(m_uploads.size()).arg(ext);
+  m_uploads.insert(name, data);
+
+  QVariantMap image;
+  image["url"] = m_baseUrl + "/images/" + name;
+
+  QString now = QDateTime::currentDateTime().toUTC().
+    toString("yyyy-MM-dd'T'hh:mm:ss'Z'");
+
+  QVariantMap obj;
+  obj["id"] = QString("%1/api/image/%2").arg(m_baseUrl).arg(name);
+  obj["objectType"] = "image";
+  obj["author"] = person(0);
+  obj["image"] = image;
+  obj["fullImage"] = image;
+  obj["published"] = now;
+  obj["updated"] = now;
+
+  m_postedObjects.insert(obj["id"].toString(), obj);
+  return obj;
+}
+
+//------------------------------------------------------------------------------
+
+bool MockData::uploadedFile(QString name, QByteArray& data) const {
+  if (!m_uploads.contains(name))
+    return false;
+  data = m_uploads[name];
+  return true;
+}
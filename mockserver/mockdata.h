@@ -0,0 +1,106 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _MOCKDATA_H_
+#define _MOCKDATA_H_
+
+#include <QVariantMap>
+#include <QStringList>
+#include <QDateTime>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+
+typedef QMap<QString, QString> QueryMap;
+
+//------------------------------------------------------------------------------
+
+/*
+  Generates the synthetic pump.io data served by the mock server. The
+  timeline is a fixed sequence of activities, number 0 being the
+  newest, and everything about an activity (verb, actor, object,
+  content) is derived from its number so the same item looks the same
+  in every feed and in every run. Activities posted by the client are
+  kept in memory and shown on top of the timeline.
+*/
+class MockData {
+public:
+  MockData(QString baseUrl, QString userName, int items, int pageSize);
+
+  QString userName() const { return m_userName; }
+
+  // Returns the number of the person with the given nickname, 0 for
+  // the user of the server and -1 if there is no such person.
+  int personNumber(QString nickname) const;
+
+  QVariantMap profile(int n) const;
+  QVariantMap selfProfile() const;
+
+  // name is one of major, minor, direct/major, direct/minor, feed
+  // (the user's own outbox) and firehose
+  bool isFeed(QString name) const;
+  QVariantMap feed(QString name, const QueryMap& query);
+
+  // which is followers or following
+  QVariantMap people(QString which, const QueryMap& query) const;
+
+  // path is the part after /api/, e.g. note/17
+  QVariantMap object(QString path) const;
+  QVariantMap replies(QString path) const;
+
+  QVariantMap post(QVariantMap activity);
+  QVariantMap upload(const QByteArray& data, QString contentType);
+  bool uploadedFile(QString name, QByteArray& data) const;
+
+private:
+  enum Verb { Post = 0, Comment, Share, Like, Follow };
+
+  int verb(int i) const;
+  bool inFeed(QString name, int i) const;
+  const QVector<int>& feedItems(QString name);
+
+  QString activityId(int key) const;
+  int keyFromId(QString id) const;
+  QVariantMap activity(int key) const;
+
+  QVariantMap note(int n, bool full) const;
+  QVariantMap comment(int n, int k) const;
+  QVariantMap person(int n) const;
+  QVariantMap collection(QString url, int totalItems,
+                         const QVariantList& items) const;
+
+  QString content(int seed) const;
+  QString timeString(int i) const;
+  int pageSize(const QueryMap& query) const;
+
+  QString m_baseUrl;
+  QString m_userName;
+  QString m_host;
+  int m_items;
+  int m_pageSize;
+  QDateTime m_startTime;
+
+  QHash<QString, QVector<int> > m_feeds;
+
+  QList<QVariantMap> m_posted;
+  QHash<QString, QVariantMap> m_postedObjects;
+  QHash<QString, QByteArray> m_uploads;
+};
+
+#endif /* _MOCKDATA_H_ */
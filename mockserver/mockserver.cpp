@@ -0,0 +1,360 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "mockserver.h"
+#include "json.h"
+
+#include <QUrl>
+#include <QStringList>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+//------------------------------------------------------------------------------
+
+// A transparent 1x1 PNG, served for all avatars and photos
+static const unsigned char s_png[] = {
+  0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
+  0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01,
+  0x08, 0x06, 0x00, 0x00, 0x00, 0x1f, 0x15, 0xc4, 0x89, 0x00, 0x00, 0x00,
+  0x0a, 0x49, 0x44, 0x41, 0x54, 0x78, 0x9c, 0x63, 0x00, 0x01, 0x00, 0x00,
+  0x05, 0x00, 0x01, 0x0d, 0x0a, 0x2d, 0xb4, 0x00, 0x00, 0x00, 0x00, 0x49,
+  0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82 };
+
+//------------------------------------------------------------------------------
+
+PendingResponse::PendingResponse(QTcpSocket* socket, const QByteArray& data,
+                                 int bytesPerSec, bool closeAfter,
+                                 QObject* parent) :
+  QObject(parent),
+  m_socket(socket),
+  m_data(data),
+  m_written(0),
+  m_bytesPerSec(bytesPerSec),
+  m_closeAfter(closeAfter)
+{
+  connect(&m_timer, SIGNAL(timeout()), this, SLOT(writeChunk()));
+}
+
+//------------------------------------------------------------------------------
+
+void PendingResponse::start() {
+  if (m_bytesPerSec > 0)
+    m_timer.start(100);
+  writeChunk();
+}
+
+//------------------------------------------------------------------------------
+
+void PendingResponse::writeChunk() {
+  if (m_socket) {
+    int chunk = m_data.size();
+    if (m_bytesPerSec > 0)
+      chunk = qMax(1, m_bytesPerSec / 10);
+
+    m_socket->write(m_data.mid(m_written, chunk));
+    m_written += chunk;
+    if (m_written < m_data.size())
+      return;
+
+    if (m_closeAfter)
+      m_socket->disconnectFromHost();
+    emit done(m_socket);
+  }
+
+  m_timer.stop();
+  deleteLater();
+}
+
+//------------------------------------------------------------------------------
+
+MockServer::MockServer(MockData* data, QObject* parent) :
+  QTcpServer(parent),
+  m_data(data),
+  m_latency(0),
+  m_bandwidth(0),
+  m_errorRate(0.0),
+  m_verbose(false)
+{
+  connect(this, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+}
+
+//------------------------------------------------------------------------------
+
+void MockServer::onNewConnection() {
+  while (hasPendingConnections()) {
+    QTcpSocket* socket = nextPendingConnection();
+    m_buffers.insert(socket, QByteArray());
+    connect(socket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+    connect(socket, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void MockServer::onReadyRead() {
+  QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+  if (!socket)
+    return;
+
+  m_buffers[socket].append(socket->readAll());
+  processNext(socket);
+}
+
+//------------------------------------------------------------------------------
+
+void MockServer::onDisconnected() {
+  QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+  if (!socket)
+    return;
+
+  m_buffers.remove(socket);
+  m_busy.remove(socket);
+  socket->deleteLater();
+}
+
+//------------------------------------------------------------------------------
+
+void MockServer::onResponseSent(QTcpSocket* socket) {
+  m_busy.remove(socket);
+  if (m_buffers.contains(socket))
+    processNext(socket);
+}
+
+//------------------------------------------------------------------------------
+
+void MockServer::processNext(QTcpSocket* socket) {
+  if (m_busy.contains(socket))
+    return;
+
+  Request req;
+  if (!takeRequest(m_buffers[socket], req))
+    return;
+
+  m_busy.insert(socket);
+
+  bool closeAfter = req.headers.value("connection").toLower() == "close";
+  PendingResponse* pr = new PendingResponse(socket, handle(req), m_bandwidth,
+                                            closeAfter, this);
+  connect(pr, SIGNAL(done(QTcpSocket*)),
+          this, SLOT(onResponseSent(QTcpSocket*)));
+  QTimer::singleShot(m_latency, pr, SLOT(start()));
+}
+
+//------------------------------------------------------------------------------
+
+static QString decode(QByteArray s) {
+  return QUrl::fromPercentEncoding(s.replace('+', ' '));
+}
+
+//------------------------------------------------------------------------------
+
+// Removes one complete request from the start of buffer.
+bool MockServer::takeRequest(QByteArray& buffer, Request& req) {
+  int headerEnd = buffer.indexOf("\r\n\r\n");
+  if (headerEnd < 0)
+    return false;
+
+  QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+  for (int i=1; i<lines.size(); i++) {
+    QByteArray line = lines[i].trimmed();
+    int colon = line.indexOf(':');
+    if (colon > 0)
+      req.headers.insert(line.left(colon).trimmed().toLower(),
+                         line.mid(colon+1).trimmed());
+  }
+
+  int length = req.headers.value("content-length").toInt();
+  if (buffer.size() < headerEnd + 4 + length)
+    return false;
+
+  req.body = buffer.mid(headerEnd + 4, length);
+
+  QList<QByteArray> requestLine = lines[0].trimmed().split(' ');
+  req.method = requestLine.value(0);
+  QByteArray target = requestLine.value(1);
+  buffer.remove(0, headerEnd + 4 + length);
+
+  int q = target.indexOf('?');
+  req.path = decode(q < 0 ? target : target.left(q));
+  if (req.path.length() > 1 && req.path.endsWith('/'))
+    req.path.chop(1);
+
+  if (q >= 0) {
+    QList<QByteArray> params = target.mid(q+1).split('&');
+    for (int i=0; i<params.size(); i++) {
+      int eq = params[i].indexOf('=');
+      if (eq > 0)
+        req.query.insert(decode(params[i].left(eq)),
+                         decode(params[i].mid(eq+1)));
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+QByteArray MockServer::response(int status, QByteArray contentType,
+                                const QByteArray& body, const Request& req) {
+  const char* reason = 
+    status == 200 ? "OK" :
+    status == 400 ? "Bad Request" :
+    status == 404 ? "Not Found" : "Internal Server Error";
+
+  if (m_verbose)
+    printf("%d %s %s (%d bytes)\n", status, req.method.constData(),
+           qPrintable(req.path), body.size());
+
+  QByteArray data = QString("HTTP/1.1 %1 %2\r\n"
+                            "Server: pumpa-mockserver\r\n"
+                            "Content-Type: %3\r\n"
+                            "Content-Length: %4\r\n\r\n").
+    arg(status).arg(reason).arg(QString(contentType)).arg(body.size()).
+    toLatin1();
+
+  if (req.method != "HEAD")
+    data += body;
+  return data;
+}
+
+//------------------------------------------------------------------------------
+
+QByteArray MockServer::jsonResponse(const QVariantMap& json,
+                                    const Request& req) {
+  return response(200, "application/json", serializeJson(json), req);
+}
+
+//------------------------------------------------------------------------------
+
+QByteArray MockServer::errorResponse(int status, QString message,
+                                     const Request& req) {
+  QVariantMap json;
+  json["error"] = message;
+  return response(status, "application/json", serializeJson(json), req);
+}
+
+//------------------------------------------------------------------------------
+
+QByteArray MockServer::handle(const Request& req) {
+  if (m_errorRate > 0.0 && qrand() < m_errorRate * (RAND_MAX + 1.0))
+    return errorResponse(500, "Simulated server error", req);
+
+  const QString& path = req.path;
+  bool post = (req.method == "POST");
+
+  // OAuth client registration and the three-legged dance
+  if (path == "/api/client/register" && post) {
+    static int clients = 0;
+    QVariantMap json;
+    json["client_id"] = QString("mock-client-%1").arg(++clients);
+    json["client_secret"] = "mock-client-secret";
+    json["expires_at"] = 0;
+    return jsonResponse(json, req);
+  }
+  if (path == "/oauth/request_token")
+    return response(200, "application/x-www-form-urlencoded",
+                    "oauth_token=mock-request-token&"
+                    "oauth_token_secret=mock-request-secret&"
+                    "oauth_callback_confirmed=true", req);
+  if (path == "/oauth/authorize")
+    return response(200, "text/html; charset=utf-8",
+                    "<html><body><h1>pumpa mock server</h1>"
+                    "<p>Token: <b>mock-request-token</b></p>"
+                    "<p>Verifier: <b>mock-verifier</b></p>"
+                    "</body></html>", req);
+  if (path == "/oauth/access_token")
+    return response(200, "application/x-www-form-urlencoded",
+                    "oauth_token=mock-access-token&"
+                    "oauth_token_secret=mock-access-secret", req);
+
+  if (path == "/.well-known/webfinger") {
+    QVariantMap json;
+    json["subject"] = req.query.value("resource");
+    json["links"] = QVariantList();
+    return jsonResponse(json, req);
+  }
+
+  if (path.startsWith("/images/")) {
+    QString name = path.mid(8);
+    QByteArray data;
+    if (m_data->uploadedFile(name, data))
+      return response(200, "image/" + name.section('.', -1).toLatin1(),
+                      data, req);
+    return response(200, "image/png",
+                    QByteArray((const char*)s_png, sizeof(s_png)), req);
+  }
+
+  if (path == "/api/firehose")
+    return jsonResponse(m_data->feed("firehose", req.query), req);
+
+  if (path.startsWith("/api/user/")) {
+    QStringList parts = path.mid(10).split('/');
+    int n = m_data->personNumber(parts[0]);
+    QString rest = QStringList(parts.mid(1)).join("/");
+
+    // Any unknown nickname is taken to be the user, so pumpa can log
+    // in with whatever name it likes.
+    if (n < 0)
+      n = 0;
+
+    if (rest.isEmpty()) {
+      QVariantMap json = m_data->selfProfile();
+      json["profile"] = m_data->profile(n);
+      return jsonResponse(json, req);
+    }
+    if (rest == "profile")
+      return jsonResponse(m_data->profile(n), req);
+    if (n != 0)
+      return errorResponse(404, "Only the user's own feeds are available",
+                           req);
+
+    if (rest.startsWith("inbox/") && m_data->isFeed(rest.mid(6)))
+      return jsonResponse(m_data->feed(rest.mid(6), req.query), req);
+
+    if (rest == "feed" && post) {
+      QVariantMap activity = parseJson(req.body);
+      if (activity["verb"].toString().isEmpty())
+        return errorResponse(400, "No verb in activity", req);
+      return jsonResponse(m_data->post(activity), req);
+    }
+    if (rest == "feed")
+      return jsonResponse(m_data->feed("feed", req.query), req);
+
+    if (rest == "uploads" && post)
+      return jsonResponse(m_data->upload(req.body,
+                                         req.headers.value("content-type")),
+                          req);
+
+    if (rest == "followers" || rest == "following")
+      return jsonResponse(m_data->people(rest, req.query), req);
+  }
+
+  if (path.startsWith("/api/")) {
+    QString objPath = path.mid(5);
+    QVariantMap json;
+    if (objPath.endsWith("/replies"))
+      json = m_data->replies(objPath.left(objPath.length() - 8));
+    else
+      json = m_data->object(objPath);
+    if (!json.isEmpty())
+      return jsonResponse(json, req);
+  }
+
+  return errorResponse(404, "No such endpoint: " + path, req);
+}
@@ -0,0 +1,116 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _MOCKSERVER_H_
+#define _MOCKSERVER_H_
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QPointer>
+#include <QTimer>
+#include <QHash>
+#include <QSet>
+
+#include "mockdata.h"
+
+//------------------------------------------------------------------------------
+
+/*
+  Writes one HTTP response to a socket, optionally throttled to a
+  number of bytes per second, and deletes itself when done.
+*/
+class PendingResponse : public QObject {
+  Q_OBJECT
+
+public:
+  PendingResponse(QTcpSocket* socket, const QByteArray& data,
+                  int bytesPerSec, bool closeAfter, QObject* parent=0);
+
+signals:
+  void done(QTcpSocket* socket);
+
+public slots:
+  void start();
+
+private slots:
+  void writeChunk();
+
+private:
+  QPointer<QTcpSocket> m_socket;
+  QByteArray m_data;
+  int m_written;
+  int m_bytesPerSec;
+  bool m_closeAfter;
+  QTimer m_timer;
+};
+
+//------------------------------------------------------------------------------
+
+/*
+  A minimal HTTP/1.1 server for the parts of the pump.io API used by
+  pumpa. OAuth signatures are not checked, any credentials work.
+  Requests on the same connection are answered one at a time, each
+  after the configured latency.
+*/
+class MockServer : public QTcpServer {
+  Q_OBJECT
+
+public:
+  MockServer(MockData* data, QObject* parent=0);
+
+  void setLatency(int msecs) { m_latency = msecs; }
+  void setBandwidth(int bytesPerSec) { m_bandwidth = bytesPerSec; }
+  void setErrorRate(double rate) { m_errorRate = rate; }
+  void setVerbose(bool verbose) { m_verbose = verbose; }
+
+private slots:
+  void onNewConnection();
+  void onReadyRead();
+  void onDisconnected();
+  void onResponseSent(QTcpSocket* socket);
+
+private:
+  struct Request {
+    QByteArray method;
+    QString path;
+    QueryMap query;
+    QHash<QByteArray, QByteArray> headers;
+    QByteArray body;
+  };
+
+  void processNext(QTcpSocket* socket);
+  bool takeRequest(QByteArray& buffer, Request& req);
+  QByteArray handle(const Request& req);
+
+  QByteArray response(int status, QByteArray contentType,
+                      const QByteArray& body, const Request& req);
+  QByteArray jsonResponse(const QVariantMap& json, const Request& req);
+  QByteArray errorResponse(int status, QString message, const Request& req);
+
+  MockData* m_data;
+  int m_latency;
+  int m_bandwidth;
+  double m_errorRate;
+  bool m_verbose;
+
+  QHash<QTcpSocket*, QByteArray> m_buffers;
+  QSet<QTcpSocket*> m_busy;
+};
+
+#endif /* _MOCKSERVER_H_ */
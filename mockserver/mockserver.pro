@@ -0,0 +1,51 @@
+# -*- mode: makefile -*-
+######################################################################
+#  Copyright 2013 Mats Sjöberg
+#  
+#  This file is part of the Pumpa programme.
+#
+#  Pumpa is free software: you can redistribute it and/or modify it
+#  under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  Pumpa is distributed in the hope that it will be useful, but
+#  WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+#  General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+######################################################################
+
+# A local server implementing enough of the pump.io API for pumpa,
+# serving synthetic timelines with configurable latency, bandwidth,
+# page size and error rate. Build with:
+#
+#   cd mockserver && qmake && make
+#
+# and see the Testing against a mock server section of the README.
+
+TEMPLATE = app
+TARGET = pumpa-mockserver
+OBJECTS_DIR = obj
+
+QT = core network
+CONFIG += console
+CONFIG -= app_bundle
+
+# Additions for Qt 4
+lessThan(QT_MAJOR_VERSION, 5) {
+  LIBS += -lqjson
+}
+
+# Additions for Qt 5
+greaterThan(QT_MAJOR_VERSION, 4) { 
+  DEFINES += QT5
+}
+
+INCLUDEPATH += ../src
+VPATH       += ../src
+
+HEADERS += mockserver.h mockdata.h json.h
+SOURCES += main.cpp mockserver.cpp mockdata.cpp json.cpp
@@ -20,11 +20,8 @@
 
 TEMPLATE = app
 TARGET = pumpa
-RESOURCES += pumpa.qrc
 OBJECTS_DIR = obj
 
-QT += core gui network
-
 #
 # To enable debug mode, run as:
 # qmake CONFIG+=debug
@@ -46,36 +43,10 @@ CONFIG(release, debug|release) {
 #  DEFINES += DEBUG_WIDGETS
 }
 
-unix:!macx {
-  message("Enabling dbus")
-  QT += dbus
-  DEFINES += USE_DBUS
-}
-
 win32 {
   RC_FILE = win32/pumpa.rc
 }
 
-# Additions for Qt 4
-lessThan(QT_MAJOR_VERSION, 5) {
-  message("Configuring for Qt 4")
-  LIBS += -lqjson
-}
-
-# Additions for Qt 5
-greaterThan(QT_MAJOR_VERSION, 4) { 
-  message("Configuring for Qt 5")
-  QT += widgets
-  DEFINES += QT5
-}
-
-# Optional spell checking support with libaspell
-exists( /usr/include/aspell.h ) {
-  message("Using aspell")
-  LIBS += -laspell
-  DEFINES += USE_ASPELL
-}
-
 # Optionally use etags
 exists( /usr/bin/etags ) {
   message("Using etags")
@@ -83,36 +54,9 @@ exists( /usr/bin/etags ) {
 }
 
 
-######################################################################
-# Main sources 
-######################################################################
+include(pumpa.pri)
 
-INCLUDEPATH += src
-VPATH       += src
-
-OBJECT_HEADERS = pumpapp.h qactivitystreams.h aswidget.h		\
-	collectionwidget.h contextwidget.h json.h messagewindow.h	\
-	messageedit.h fancyhighlighter.h qaspell.h actorwidget.h	\
-	filedownloader.h richtextlabel.h oauthwizard.h tabwidget.h	\
-	util.h pumpasettingsdialog.h pumpasettings.h activitywidget.h	\
-	objectwidget.h shortobjectwidget.h fullobjectwidget.h		\
-	imagelabel.h texttoolbutton.h objectwidgetwithsignals.h		\
-	objectlistwidget.h qasabstractobject.h qasobject.h qasactor.h	\
-	qasactivity.h qasobjectlist.h qasactorlist.h qascollection.h	\
-	qasabstractobjectlist.h
-
-OBJECT_SOURCES = $$replace(OBJECT_HEADERS, \\.h, .cpp)
-OBJECT_ALL = $$OBJECT_HEADERS $$OBJECT_SOURCES
-
-SUNDOWN_HEADERS = sundown/markdown.h sundown/html.h sundown/buffer.h
-
-SUNDOWN_SOURCES = sundown/autolink.c sundown/buffer.c		\
-	sundown/houdini_href_e.c sundown/houdini_html_e.c	\
-	sundown/html.c sundown/markdown.c sundown/stack.c
-
-HEADERS += $$OBJECT_HEADERS $$SUNDOWN_HEADERS pumpa_defines.h
 SOURCES += main.cpp
-SOURCES += $$OBJECT_SOURCES $$SUNDOWN_SOURCES
 
 ######################################################################
 # Translation files
@@ -125,39 +69,6 @@ TRANSLATIONS = \
 	translations/pumpa_nvi.ts
 
 
-######################################################################
-# kQOAuth sources
-######################################################################
-
-INCLUDEPATH += src/kQOAuth
-VPATH       += src/kQOAuth
-
-PUBLIC_HEADERS += kqoauthmanager.h \
-                  kqoauthrequest.h \
-                  kqoauthrequest_1.h \
-                  kqoauthrequest_xauth.h \
-                  kqoauthglobals.h 
-
-PRIVATE_HEADERS +=  kqoauthrequest_p.h \
-                    kqoauthmanager_p.h \
-                    kqoauthauthreplyserver.h \
-                    kqoauthauthreplyserver_p.h \
-                    kqoauthutils.h \
-                    kqoauthrequest_xauth_p.h
-
-HEADERS += \
-    $$PUBLIC_HEADERS \
-    $$PRIVATE_HEADERS 
-
-SOURCES += \
-    kqoauthmanager.cpp \
-    kqoauthrequest.cpp \
-    kqoauthutils.cpp \
-    kqoauthauthreplyserver.cpp \
-    kqoauthrequest_1.cpp \
-    kqoauthrequest_xauth.cpp
-
-
 ######################################################################
 # Generate documentation
 ######################################################################
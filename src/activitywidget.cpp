@@ -80,17 +80,15 @@ void ActivityWidget::changeObject(QASAbstractObject* aObj) {
   if (!m_activity)
     return;
 
-  const QString verb = m_activity->verb();
   QASObject* obj = m_activity->object();
-  QString objType = obj->type();
 
-  bool fullObject = (verb == "post");
+  bool fullObject = (m_activity->verbId() == QASActivity::PostVerb);
   
   m_objectWidget->changeObject(obj, fullObject);
 
   bool objectVisible = !obj->content().isEmpty() ||
     !obj->displayName().isEmpty()
-    || (objType == "image" && !obj->imageUrl().isEmpty());
+    || (obj->typeId() == QASObject::ImageType && !obj->imageUrl().isEmpty());
 
   m_objectWidget->setVisible(objectVisible);
 
@@ -113,15 +111,16 @@ void ActivityWidget::refreshTimeLabels() {
 //------------------------------------------------------------------------------
 
 void ActivityWidget::updateText() {
-  QString verb = m_activity->verb();
+  int verb = m_activity->verbId();
   QString text = m_activity->content();
-  QString objType = m_activity->object()->type();
+  int objType = m_activity->object()->typeId();
 
   QString generatorName = m_activity->generatorName();
-  if (!generatorName.isEmpty() && (verb != "share"))
+  if (!generatorName.isEmpty() && (verb != QASActivity::ShareVerb))
     text += QString(tr(" via %1")).arg(generatorName);
 
-  if (verb == "post" && (objType == "note" || objType == "image")) {
+  if (verb == QASActivity::PostVerb &&
+      (objType == QASObject::NoteType || objType == QASObject::ImageType)) {
     if (m_activity->hasTo())
       text += " " + tr("To:") +" " + recipientsToString(m_activity->to());
     
@@ -142,7 +141,8 @@ QString ActivityWidget::recipientsToString(QASObjectList* rec) {
 
   for (size_t i=0; i<rec->size(); ++i) {
     QASObject* r = rec->at(i);
-    if (r->type() == "collection" && r->id() == PUBLIC_RECIPIENT_ID) {
+    if (r->typeId() == QASObject::CollectionType &&
+        r->id() == PUBLIC_RECIPIENT_ID) {
       ret << tr("Public");
     } else {
       QString name = r->displayName();
@@ -18,12 +18,12 @@
 */
 
 #include "actorwidget.h"
-#include "filedownloader.h"
+#include "objectwidgetwithsignals.h"
 
 //------------------------------------------------------------------------------
 
 ActorWidget::ActorWidget(QASActor* a, QWidget* parent, bool small) :
-  QLabel(parent), m_actor(a)
+  QLabel(parent), m_actor(a), m_waiting(false)
 {
 #ifdef DEBUG_WIDGETS
   qDebug() << "Creating ActorWidget" << (m_actor ? m_actor->id() : "NULL");
@@ -58,20 +58,38 @@ void ActorWidget::setActor(QASActor* a) {
 //------------------------------------------------------------------------------
 
 void ActorWidget::onImageChanged() {
-  m_url = m_actor ? m_actor->imageUrl() : "";
+  QString url = m_actor ? m_actor->imageUrl() : "";
+  if (url != m_url)
+    m_downloads.clear();
+  m_url = url;
   updatePixmap();
 }
 
 //------------------------------------------------------------------------------
 
 void ActorWidget::updatePixmap() {
+  m_waiting = false;
   if (m_url.isEmpty()) {
     setPixmap(QPixmap(":/images/default.png"));
     return;
   }
 
-  FileDownloader* fd = FileDownloader::get(m_url, true);
+  FileDownloader* fd = FileDownloader::get(m_url);
   connect(fd, SIGNAL(fileReady()), this, SLOT(updatePixmap()),
           Qt::UniqueConnection);
+  m_waiting = !fd->ready();
+  if (m_waiting && ObjectWidgetWithSignals::imagesWanted(this))
+    m_downloads.add(fd, FileDownloader::AvatarPriority);
+  else
+    m_downloads.clear();
   setPixmap(fd->pixmap(":/images/default.png"));
 }
+
+//------------------------------------------------------------------------------
+
+void ActorWidget::updateDownload() {
+  if (!ObjectWidgetWithSignals::imagesWanted(this))
+    m_downloads.clear();
+  else if (m_waiting)
+    updatePixmap();
+}
@@ -25,6 +25,7 @@
 #include <QMouseEvent>
 
 #include "qactivitystreams.h"
+#include "filedownloader.h"
 
 //------------------------------------------------------------------------------
 
@@ -40,10 +41,16 @@ public slots:
   void onImageChanged();
   void updatePixmap();
 
+  // Starts or cancels the download of the image depending on
+  // ObjectWidgetWithSignals::imagesWanted().
+  void updateDownload();
+
 private:
   QASActor* m_actor;
   QString m_url;
   QString m_localFile;
+  WantedDownloads m_downloads;
+  bool m_waiting;
 };
 
 #endif /* _ACTORWIDGET_H_ */
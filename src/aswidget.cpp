@@ -19,11 +19,59 @@
 
 #include "aswidget.h"
 #include "activitywidget.h"
+#include "fullobjectwidget.h"
+#include "perfstats.h"
+#include "tracelog.h"
 #include <QScrollBar>
+#include <QLayoutItem>
+#include <QElapsedTimer>
 #include <QDebug>
 
 //------------------------------------------------------------------------------
 
+int ASWidget::s_imagePrefetch = 1;
+
+//------------------------------------------------------------------------------
+
+// Layout item of one row, caching heightForWidth() in the widget.
+class TimelineRowItem : public QWidgetItemV2 {
+public:
+  TimelineRowItem(ObjectWidgetWithSignals* ow) :
+    QWidgetItemV2(ow), m_row(ow) {}
+
+  virtual int heightForWidth(int w) const {
+    if (isEmpty())
+      return -1;
+
+    int h = m_row->cachedHeightForWidth(w);
+    if (h < 0) {
+      h = QWidgetItemV2::heightForWidth(w);
+      m_row->cacheHeightForWidth(w, h);
+    }
+    return h;
+  }
+
+private:
+  ObjectWidgetWithSignals* m_row;
+};
+
+//------------------------------------------------------------------------------
+
+void TimelineLayout::insertRow(int index, ObjectWidgetWithSignals* ow) {
+  addChildWidget(ow);
+  ow->clearHeightCache();
+  insertItem(index, new TimelineRowItem(ow));
+}
+
+//------------------------------------------------------------------------------
+
+void TimelineLayout::setGeometry(const QRect& r) {
+  ProfileScope profileScope("TimelineLayout::setGeometry", "layout");
+  QVBoxLayout::setGeometry(r);
+}
+
+//------------------------------------------------------------------------------
+
 ASWidget::ASWidget(QWidget* parent, int widgetLimit, int purgeWait) :
   QScrollArea(parent),
   m_firstTime(true),
@@ -31,11 +79,28 @@ ASWidget::ASWidget(QWidget* parent, int widgetLimit, int purgeWait) :
   m_asMode(QAS_NULL),
   m_purgeWait(purgeWait),
   m_purgeCounter(purgeWait),
-  m_widgetLimit(widgetLimit)
+  m_widgetLimit(widgetLimit),
+  m_updatePending(false),
+  m_sliceNewRows(0)
 {
   m_reuseWidgets = (m_widgetLimit > 0);
 
-  m_itemLayout = new QVBoxLayout;
+  m_continueTimer = new QTimer(this);
+  m_continueTimer->setSingleShot(true);
+  m_continueTimer->setInterval(0);
+  connect(m_continueTimer, SIGNAL(timeout()), this, SLOT(update()));
+
+  // Waits for the scrolling to settle a bit before starting downloads
+  m_imageTimer = new QTimer(this);
+  m_imageTimer->setSingleShot(true);
+  m_imageTimer->setInterval(50);
+  connect(m_imageTimer, SIGNAL(timeout()), this, SLOT(updateImageLoading()));
+  connect(verticalScrollBar(), SIGNAL(valueChanged(int)),
+          this, SLOT(scheduleImageLoading()));
+  connect(verticalScrollBar(), SIGNAL(rangeChanged(int, int)),
+          this, SLOT(scheduleImageLoading()));
+
+  m_itemLayout = new TimelineLayout;
   m_itemLayout->setSpacing(10);
 
   m_listContainer = new QWidget;
@@ -49,6 +114,16 @@ ASWidget::ASWidget(QWidget* parent, int widgetLimit, int purgeWait) :
 
 //------------------------------------------------------------------------------
 
+ASWidget::~ASWidget() {
+  // Lets request timers waiting for the rest of the update finish
+  if (m_updatePending) {
+    WidgetTimer widgetTimer;
+    PerfStats::setUpdatePending(false);
+  }
+}
+
+//------------------------------------------------------------------------------
+
 void ASWidget::clear() {
   QLayoutItem* item;
   while ((item = m_itemLayout->takeAt(0)) != 0) {
@@ -126,6 +201,55 @@ void ASWidget::keyPressEvent(QKeyEvent* event) {
 
 //------------------------------------------------------------------------------
 
+void ASWidget::showEvent(QShowEvent* event) {
+  QScrollArea::showEvent(event);
+  scheduleImageLoading();
+}
+
+//------------------------------------------------------------------------------
+
+void ASWidget::scheduleImageLoading() {
+  if (!m_imageTimer->isActive())
+    m_imageTimer->start();
+}
+
+//------------------------------------------------------------------------------
+
+/*
+  Rows within s_imagePrefetch viewport heights of the visible area get
+  their images, rows further than ImageCancelPages beyond that have
+  their downloads cancelled, and the ones in between are left as they
+  are so that scrolling back and forth a bit doesn't restart
+  downloads. Hidden timelines are left alone until shown.
+*/
+void ASWidget::updateImageLoading() {
+  if (!isVisible())
+    return;
+
+  ProfileScope profileScope("ASWidget::updateImageLoading", "image");
+
+  int h = viewport()->height();
+  int top = -m_listContainer->y();
+  int loadTop = top - s_imagePrefetch*h;
+  int loadBottom = top + h + s_imagePrefetch*h;
+  int keepTop = loadTop - ImageCancelPages*h;
+  int keepBottom = loadBottom + ImageCancelPages*h;
+
+  for (int i=0; i<m_itemLayout->count(); i++) {
+    ObjectWidgetWithSignals* ow = widgetAt(i);
+    if (!ow)
+      continue;
+
+    QRect g = ow->geometry();
+    if (g.bottom() >= loadTop && g.top() <= loadBottom)
+      ow->setImagesWanted(true);
+    else if (g.bottom() < keepTop || g.top() > keepBottom)
+      ow->setImagesWanted(false);
+  }
+}
+
+//------------------------------------------------------------------------------
+
 ObjectWidgetWithSignals* ASWidget::widgetAt(int idx) {
   QLayoutItem* item = m_itemLayout->itemAt(idx);
 
@@ -156,14 +280,35 @@ QASAbstractObject* ASWidget::objectAt(int idx) {
 //------------------------------------------------------------------------------
 
 void ASWidget::update() {
+  WidgetTimer widgetTimer;
+  ProfileScope profileScope("ASWidget::update", "widgets");
+
   /* 
      We assume m_list contains all objects, but new ones might have
      been added either (or both) to the top or end. Go through from
      top (newest) to bottom. If the object doesn't exist add it, if it
      does increment the counter (go further down both in the
      collection and widget list).
+
+     Widgets are created for at most UpdateSliceMsecs at a time, after
+     which we return to the event loop and continue in a new call,
+     which again starts from the top. The widgets created so far
+     are in the right order, so they are just skipped, and the ones
+     at the top (m_sliceNewRows) don't count as older. The first
+     slice fills at least the visible area.
   */
 
+  QElapsedTimer sliceTimer;
+  sliceTimer.start();
+  bool firstSlice = !m_updatePending;
+  m_updatePending = false;
+  int filledHeight = 0;
+
+  if (firstSlice) {
+    m_sliceNewRows = 0;
+    precomputeText();
+  }
+
   int li = 0; 
   int newCount = 0;
   bool older = false;
@@ -176,8 +321,9 @@ void ASWidget::update() {
 
     QASAbstractObject* wObj = objectAt(li);
     if (wObj == cObj) {
+      if (li >= m_sliceNewRows)
+        older = true;
       li++;
-      older = true;
       continue;
     }
 
@@ -206,16 +352,26 @@ void ASWidget::update() {
 
       QASAbstractObject* obj = ow->asObject();
       m_itemLayout->removeWidget(ow);
+      if (idx < m_sliceNewRows)
+        m_sliceNewRows--;
 
       m_object_set.remove(obj);
       m_list->removeObject(obj);
 
       ow->changeObject(cObj);
-      m_itemLayout->insertWidget(li++, ow);
+      m_itemLayout->insertRow(li++, ow);
+      m_sliceNewRows++;
     } else {
-      ObjectWidgetWithSignals* ow = createWidget(cObj, countAsNew);
+      ObjectWidgetWithSignals* ow;
+      {
+        ProfileScope createScope("createWidget", "widgets");
+        ow = createWidget(cObj, countAsNew);
+      }
       ObjectWidgetWithSignals::connectSignals(ow, this);
-      m_itemLayout->insertWidget(li++, ow);
+      m_itemLayout->insertRow(li++, ow);
+      if (!older)
+        m_sliceNewRows++;
+      filledHeight += ow->sizeHint().height();
       
 #ifdef DEBUG_WIDGETS
       qDebug() << "Created widget" << cObj->apiLink() << m_list->url();
@@ -224,11 +380,43 @@ void ASWidget::update() {
 
     if (countAsNew && !older)
       newCount++;
+
+    if (sliceTimer.elapsed() > UpdateSliceMsecs && i+1 < m_list->size() &&
+        (!firstSlice || filledHeight > viewport()->height())) {
+      m_updatePending = true;
+      m_continueTimer->start();
+      break;
+    }
   }
 
   if (newCount && !isVisible() && !m_firstTime)
     emit highlightMe();
-  m_firstTime = false;
+  if (!m_updatePending)
+    m_firstTime = false;
+  if (m_updatePending == firstSlice)
+    PerfStats::setUpdatePending(m_updatePending);
+
+  scheduleImageLoading();
+}
+
+//------------------------------------------------------------------------------
+
+// Starts filtering the display HTML of the objects that don't have
+// widgets yet in the background, while the widgets are created one by
+// one.
+void ASWidget::precomputeText() {
+  QList<QASObject*> objs;
+  for (size_t i=0; i<m_list->size(); i++) {
+    QASAbstractObject* aObj = m_list->at(i);
+    if (m_object_set.contains(aObj) || aObj->isDeleted())
+      continue;
+
+    QASActivity* act = qobject_cast<QASActivity*>(aObj);
+    QASObject* obj = act ? act->object() : qobject_cast<QASObject*>(aObj);
+    if (obj)
+      objs << obj;
+  }
+  FullObjectWidget::precomputeText(objs);
 }
 
 //------------------------------------------------------------------------------
@@ -26,6 +26,25 @@
 #include <QWidget>
 #include <QScrollArea>
 #include <QVBoxLayout>
+#include <QTimer>
+
+//------------------------------------------------------------------------------
+
+/*
+  The vertical layout of a timeline. Object widgets inserted with
+  insertRow() answer heightForWidth() from the widget's own height
+  cache, so relayouting the timeline only lays out the rows whose
+  contents have changed, or all of them when the width changes to one
+  not seen before.
+*/
+class TimelineLayout : public QVBoxLayout {
+public:
+  TimelineLayout() {}
+
+  void insertRow(int index, ObjectWidgetWithSignals* ow);
+
+  virtual void setGeometry(const QRect& r);
+};
 
 //------------------------------------------------------------------------------
 
@@ -34,6 +53,7 @@ class ASWidget : public QScrollArea {
 
 public:
   ASWidget(QWidget* parent, int widgetLimit=-1, int purgeWait=10);
+  virtual ~ASWidget();
   virtual void refreshTimeLabels();
   virtual void fetchNewer();
   virtual void fetchOlder();
@@ -41,6 +61,14 @@ public:
 
   int count() const { return m_object_set.size(); }
 
+  // True while update() has yielded to the event loop with widgets
+  // still left to create, it will be called again shortly.
+  bool updatePending() const { return m_updatePending; }
+
+  // Images are downloaded for rows within this many viewport heights
+  // of the visible area.
+  static void setImagePrefetch(int pages) { s_imagePrefetch = qMax(pages, 0); }
+
 signals:
   void highlightMe();  
   void request(QString, int);
@@ -54,6 +82,8 @@ signals:
 
 protected slots:
   virtual void update();
+  void updateImageLoading();
+  void scheduleImageLoading();
 
 protected:
   virtual QASAbstractObjectList* initList(QString endpoint, QObject* parent);
@@ -64,11 +94,21 @@ protected:
                                                 bool& countAsNew);
 
   void keyPressEvent(QKeyEvent* event);
+  virtual void showEvent(QShowEvent* event);
   virtual void clear();
 
   void refreshObject(QASAbstractObject* obj);
+  void precomputeText();
+
+  // Time budget in milliseconds for creating widgets in one update()
+  // call before the rest is left for the next event loop iteration.
+  static const int UpdateSliceMsecs = 15;
 
-  QVBoxLayout* m_itemLayout;
+  // Downloads for rows this many viewport heights further away than
+  // the prefetch distance are cancelled.
+  static const int ImageCancelPages = 2;
+
+  TimelineLayout* m_itemLayout;
   QWidget* m_listContainer;
   bool m_firstTime;
 
@@ -81,6 +121,15 @@ protected:
   int m_purgeWait;
   int m_purgeCounter;
   int m_widgetLimit;
+
+  bool m_updatePending;
+  QTimer* m_continueTimer;
+  // Rows added at the top by the earlier slices of the current
+  // update(), which aren't older than the objects still to come.
+  int m_sliceNewRows;
+  QTimer* m_imageTimer;
+
+  static int s_imagePrefetch;
 };
 
 #endif /* _ASWIDGET_H_ */
@@ -45,7 +45,7 @@ void ContextWidget::setObject(QASObject* obj) {
   connect(ow, SIGNAL(showContext(QASObject*)),
           this, SIGNAL(showContext(QASObject*)));
 
-  m_itemLayout->insertWidget(0, ow);
+  m_itemLayout->insertRow(0, ow);
   m_itemLayout->addStretch();
 
   refreshObject(m_object);
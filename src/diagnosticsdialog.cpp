@@ -0,0 +1,139 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "diagnosticsdialog.h"
+#include "perfstats.h"
+#include "stallwatchdog.h"
+#include "memorystats.h"
+
+#include <QVBoxLayout>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QTextStream>
+#include <QDateTime>
+#include <QFile>
+
+//------------------------------------------------------------------------------
+
+DiagnosticsDialog::DiagnosticsDialog(QTabWidget* tabs, QWidget* parent) :
+  QDialog(parent),
+  m_timelineTabs(tabs)
+{
+  setWindowTitle(tr("Pumpa diagnostics"));
+  resize(640, 480);
+
+  m_tabs = new QTabWidget(this);
+  m_networkText = addPage(tr("Network"));
+  m_stallsText = addPage(tr("Stalls"));
+  m_memoryText = addPage(tr("Memory"));
+
+  m_buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, 
+                                     Qt::Horizontal, this);
+  m_refreshButton = m_buttonBox->addButton(tr("Refresh"),
+                                           QDialogButtonBox::ActionRole);
+  m_clearButton = m_buttonBox->addButton(tr("Clear"),
+                                         QDialogButtonBox::ResetRole);
+  m_saveButton = m_buttonBox->addButton(tr("Save..."),
+                                        QDialogButtonBox::ActionRole);
+  connect(m_refreshButton, SIGNAL(clicked()), this, SLOT(refresh()));
+  connect(m_clearButton, SIGNAL(clicked()), this, SLOT(onClearClicked()));
+  connect(m_saveButton, SIGNAL(clicked()), this, SLOT(onSaveClicked()));
+  connect(m_buttonBox, SIGNAL(rejected()), this, SLOT(reject()));
+
+  QVBoxLayout* layout = new QVBoxLayout;
+  layout->addWidget(m_tabs);
+  layout->addWidget(m_buttonBox);
+  setLayout(layout);
+}
+
+//------------------------------------------------------------------------------
+
+QPlainTextEdit* DiagnosticsDialog::addPage(QString title) {
+  QPlainTextEdit* text = new QPlainTextEdit(this);
+  text->setReadOnly(true);
+  text->setLineWrapMode(QPlainTextEdit::NoWrap);
+
+  QFont font("Monospace");
+  font.setStyleHint(QFont::TypeWriter);
+  text->setFont(font);
+
+  m_tabs->addTab(text, title);
+  return text;
+}
+
+//------------------------------------------------------------------------------
+
+void DiagnosticsDialog::showEvent(QShowEvent* event) {
+  refresh();
+  QDialog::showEvent(event);
+}
+
+//------------------------------------------------------------------------------
+
+void DiagnosticsDialog::refresh() {
+  m_networkText->setPlainText(PerfStats::report());
+  m_stallsText->setPlainText(StallWatchdog::report());
+  m_memoryText->setPlainText(MemoryStats::report(m_timelineTabs));
+}
+
+//------------------------------------------------------------------------------
+
+QString DiagnosticsDialog::reportText() const {
+  QString text = QString("Pumpa diagnostics %1\n\n")
+    .arg(QDateTime::currentDateTime().toString(Qt::ISODate));
+  for (int i=0; i<m_tabs->count(); i++) {
+    QPlainTextEdit* page = qobject_cast<QPlainTextEdit*>(m_tabs->widget(i));
+    if (!page)
+      continue;
+    text += QString("== %1 ==\n\n").arg(m_tabs->tabText(i));
+    text += page->toPlainText() + "\n\n";
+  }
+  return text;
+}
+
+//------------------------------------------------------------------------------
+
+void DiagnosticsDialog::onClearClicked() {
+  PerfStats::clear();
+  StallWatchdog::clear();
+  refresh();
+}
+
+//------------------------------------------------------------------------------
+
+void DiagnosticsDialog::onSaveClicked() {
+  refresh();
+
+  QString fileName =
+    QFileDialog::getSaveFileName(this, tr("Save diagnostics"),
+                                 "pumpa-diagnostics.txt");
+  if (fileName.isEmpty())
+    return;
+
+  QFile fp(fileName);
+  if (!fp.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    QMessageBox::warning(this, tr("Pumpa diagnostics"),
+                         tr("Could not open file %1 for writing: ").
+                         arg(fileName) + fp.errorString());
+    return;
+  }
+
+  QTextStream out(&fp);
+  out << reportText();
+}
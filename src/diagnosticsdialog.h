@@ -0,0 +1,68 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _DIAGNOSTICSDIALOG_H_
+#define _DIAGNOSTICSDIALOG_H_
+
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QTabWidget>
+#include <QPlainTextEdit>
+
+//------------------------------------------------------------------------------
+
+class DiagnosticsDialog : public QDialog {
+  Q_OBJECT
+
+public:
+  // The widgets of each page in tabs are included in the memory
+  // accounting.
+  DiagnosticsDialog(QTabWidget* tabs=0, QWidget* parent=0);
+
+  // Full text of all pages, as written by Save.
+  QString reportText() const;
+
+public slots:
+  void refresh();
+
+protected:
+  void showEvent(QShowEvent* event);
+
+private slots:
+  void onClearClicked();
+  void onSaveClicked();
+
+private:
+  QPlainTextEdit* addPage(QString title);
+
+  QTabWidget* m_tabs;
+  QPlainTextEdit* m_networkText;
+  QPlainTextEdit* m_stallsText;
+  QPlainTextEdit* m_memoryText;
+
+  QTabWidget* m_timelineTabs;
+
+  QPushButton* m_refreshButton;
+  QPushButton* m_clearButton;
+  QPushButton* m_saveButton;
+  QDialogButtonBox* m_buttonBox;
+};
+
+#endif /* _DIAGNOSTICSDIALOG_H_ */
@@ -18,6 +18,7 @@
 */
 
 #include "fancyhighlighter.h"
+#include "tracelog.h"
 
 #include <QRegExp>
 
@@ -48,6 +49,7 @@ void FancyHighlighter::formatMarkup(QString text, QString begin,
 //------------------------------------------------------------------------------
 
 void FancyHighlighter::highlightBlock(const QString& text) {
+  ProfileScope profileScope("FancyHighlighter::highlightBlock", "text");
   int index;
   QTextCharFormat urlHighlightFormat;
   urlHighlightFormat.setForeground(QBrush(Qt::blue));
@@ -19,6 +19,9 @@
 
 #include "filedownloader.h"
 #include "pumpa_defines.h"
+#include "trafficrecorder.h"
+#include "tracelog.h"
+#include "util.h"
 
 #ifdef QT5
 #include <QStandardPaths>
@@ -32,6 +35,15 @@
 
 QString FileDownloader::m_cacheDir;
 QMap<QString, FileDownloader*> FileDownloader::m_downloading;
+bool FileDownloader::s_offline = false;
+int FileDownloader::s_cancelled = 0;
+int FileDownloader::s_running = 0;
+QList<FileDownloader*> FileDownloader::s_queue[NumPriorities];
+
+bool FileDownloader::s_deduplicate = true;
+QHash<QByteArray, QString> FileDownloader::s_contentFiles;
+int FileDownloader::s_duplicates = 0;
+qint64 FileDownloader::s_duplicateBytes = 0;
 
 QString FileDownloader::s_siteUrl;
 QString FileDownloader::s_clientId;
@@ -65,7 +77,15 @@ void FileDownloader::setOAuthInfo(QString siteUrl,
 //------------------------------------------------------------------------------
 FileDownloader::FileDownloader(const QString& url) :
   m_downloadingUrl(url),
-  m_downloadStarted(false)
+  m_key(canonicalImageUrl(url)),
+  m_timer(NULL),
+  m_traceId(-1),
+  m_downloadStarted(false),
+  m_running(false),
+  m_wanted(0),
+  m_priority(NumPriorities-1),
+  m_retries(0),
+  m_retryTimer(NULL)
 {
   QString fn = urlToPath(m_downloadingUrl);
 
@@ -73,12 +93,16 @@ FileDownloader::FileDownloader(const QString& url) :
     m_cachedFile = fn;
   } else {
     m_cachedFile = "";
-    m_downloading.insert(m_downloadingUrl, this);
+    m_downloading.insert(m_key, this);
 
     oaRequest = new KQOAuthRequest(this);
     oaManager = new KQOAuthManager(this);
-    connect(oaManager, SIGNAL(authorizedRequestReady(QByteArray, int)),
-            this, SLOT(onAuthorizedRequestReady(QByteArray, int)));
+    connect(oaManager,
+            SIGNAL(authorizedRequestFinished(QByteArray, int,
+                                             KQOAuthManager::KQOAuthError)),
+            this,
+            SLOT(onAuthorizedRequestReady(QByteArray, int,
+                                          KQOAuthManager::KQOAuthError)));
     connect(oaManager, SIGNAL(errorMessage(QString)),
             this, SIGNAL(networkError(QString)));
 
@@ -93,20 +117,75 @@ FileDownloader::FileDownloader(const QString& url) :
 //------------------------------------------------------------------------------
 
 FileDownloader* FileDownloader::get(const QString& url, bool download) {
-  if (m_downloading.contains(url))
-    return m_downloading[url];
+  // The proxy and direct URLs of an image share the same downloader
+  FileDownloader* fd = m_downloading.value(canonicalImageUrl(url));
+  if (fd) {
+    if (download && !fd->ready())
+      fd->want();
+    return fd;
+  }
 
-  FileDownloader* fd = new FileDownloader(url);
+  fd = new FileDownloader(url);
   if (download && !fd->ready())
-    fd->download();
+    fd->want();
   return fd;
 }
 
 //------------------------------------------------------------------------------
 
+int FileDownloader::queuedCount() {
+  int count = 0;
+  for (int p=0; p<NumPriorities; p++)
+    count += s_queue[p].count();
+  return count;
+}
+
+//------------------------------------------------------------------------------
+
 void FileDownloader::download() {
-  if (m_downloadStarted)
+  if (m_downloadStarted || s_offline || ready())
     return;
+  m_downloadStarted = true;
+  m_retries = 0;
+
+  if (TraceLog::active()) {
+    m_traceId = TraceLog::nextId();
+    TraceLog::asyncBegin("download", "network", m_traceId, m_downloadingUrl);
+  }
+
+  enqueue();
+}
+
+//------------------------------------------------------------------------------
+
+void FileDownloader::enqueue() {
+  // The time spent in the queue is counted as the queued phase
+  if (!m_timer)
+    m_timer = new RequestTimer(PerfStats::Avatar, this);
+
+  s_queue[m_priority].append(this);
+  startQueued();
+}
+
+//------------------------------------------------------------------------------
+
+void FileDownloader::startQueued() {
+  while (s_running < MAX_DOWNLOADS) {
+    FileDownloader* fd = NULL;
+    for (int p=0; p<NumPriorities && !fd; p++)
+      if (!s_queue[p].isEmpty())
+        fd = s_queue[p].takeFirst();
+    if (!fd)
+      return;
+    fd->start();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void FileDownloader::start() {
+  m_running = true;
+  s_running++;
 
   if (m_downloadingUrl.startsWith(s_siteUrl)) {
     oaRequest->initRequest(KQOAuthRequest::AuthorizedRequest,
@@ -120,12 +199,138 @@ void FileDownloader::download() {
 
     oaRequest->setHttpMethod(KQOAuthRequest::GET); 
 
-    oaManager->executeAuthorizedRequest(oaRequest, 0);
+    if (!oaManager->executeAuthorizedRequest(oaRequest, 0)) {
+      // Nothing was sent, so no reply will come to free the slot
+      downloadFailed(QString(tr("Unable to download %1 (Error #%2)."))
+                     .arg(m_downloadingUrl).arg(oaManager->lastError()));
+      return;
+    }
+    m_reply = oaManager->getReply(oaRequest);
   } else {
-    m_nam->get(QNetworkRequest(QUrl(m_downloadingUrl)));
+    m_reply = m_nam->get(QNetworkRequest(QUrl(m_downloadingUrl)));
   }
-  
-  m_downloadStarted = true;
+  m_timer->setReply(m_reply);
+}
+
+//------------------------------------------------------------------------------
+
+// Gives the slot of a running download to the next one in the queue.
+void FileDownloader::stopRunning() {
+  m_reply = NULL;
+  if (!m_running)
+    return;
+
+  m_running = false;
+  s_running--;
+  QTimer::singleShot(0, this, SLOT(startNext()));
+}
+
+//------------------------------------------------------------------------------
+
+void FileDownloader::startNext() {
+  startQueued();
+}
+
+//------------------------------------------------------------------------------
+
+void FileDownloader::cancel() {
+  if (!m_downloadStarted)
+    return;
+
+  // Cleared first, so that the finished signals of the aborted reply
+  // are ignored.
+  m_downloadStarted = false;
+  s_cancelled++;
+
+  for (int p=0; p<NumPriorities; p++)
+    s_queue[p].removeOne(this);
+  if (m_retryTimer)
+    m_retryTimer->stop();
+
+  if (m_timer) {
+    m_timer->deleteLater();
+    m_timer = NULL;
+  }
+
+  if (m_traceId >= 0) {
+    TraceLog::asyncEnd("download", "network", m_traceId, "cancelled");
+    m_traceId = -1;
+  }
+
+  QNetworkReply* reply = m_reply;
+  stopRunning();
+  if (reply)
+    reply->abort();
+}
+
+//------------------------------------------------------------------------------
+
+void FileDownloader::want(int priority) {
+  m_wanted++;
+  setPriority(priority);
+  if (!ready())
+    download();
+}
+
+//------------------------------------------------------------------------------
+
+void FileDownloader::unwant() {
+  if (m_wanted > 0 && --m_wanted == 0)
+    cancel();
+}
+
+//------------------------------------------------------------------------------
+
+void FileDownloader::setPriority(int priority) {
+  if (priority < 0 || priority >= m_priority)
+    return;
+
+  if (s_queue[m_priority].removeOne(this))
+    s_queue[priority].append(this);
+  m_priority = priority;
+}
+
+//------------------------------------------------------------------------------
+
+/*
+  Tries again later if someone still wants the file, otherwise gives
+  up and reports msg.
+*/
+void FileDownloader::downloadFailed(QString msg) {
+  stopRunning();
+
+  if (m_timer) {
+    m_timer->deleteLater();
+    m_timer = NULL;
+  }
+
+  if (m_wanted > 0 && m_retries < DOWNLOAD_RETRIES) {
+    if (!m_retryTimer) {
+      m_retryTimer = new QTimer(this);
+      m_retryTimer->setSingleShot(true);
+      connect(m_retryTimer, SIGNAL(timeout()), this, SLOT(retry()));
+    }
+    m_retryTimer->start(DOWNLOAD_RETRY_MSECS << m_retries);
+    m_retries++;
+    return;
+  }
+
+  m_downloadStarted = false;
+  m_downloading.remove(m_key);
+
+  if (m_traceId >= 0) {
+    TraceLog::asyncEnd("download", "network", m_traceId, "failed");
+    m_traceId = -1;
+  }
+
+  emit networkError(msg);
+}
+
+//------------------------------------------------------------------------------
+
+void FileDownloader::retry() {
+  if (m_downloadStarted)
+    enqueue();
 }
 
 //------------------------------------------------------------------------------
@@ -168,41 +373,85 @@ void FileDownloader::onSslErrors(QNetworkReply* reply,
 //------------------------------------------------------------------------------
 
 void FileDownloader::replyFinished(QNetworkReply* nr) {
+  if (!m_downloadStarted || nr != m_reply) {
+    nr->deleteLater();
+    return;
+  }
+
   if (nr->error()) {
-    emit networkError(tr("Network error: ")+nr->errorString());
+    downloadFailed(tr("Network error: ")+nr->errorString());
+    nr->deleteLater();
     return;
   }
-  onAuthorizedRequestReady(nr->readAll(), 0);
+  onAuthorizedRequestReady(nr->readAll(), 0, KQOAuthManager::NoError);
   nr->deleteLater();
 }
 
 //------------------------------------------------------------------------------
 
-void FileDownloader::onAuthorizedRequestReady(QByteArray response, int) {
-  m_downloading.remove(m_downloadingUrl);
+void FileDownloader::onAuthorizedRequestReady(QByteArray response, int,
+                                    KQOAuthManager::KQOAuthError error) {
+  ProfileScope profileScope("FileDownloader::onAuthorizedRequestReady",
+                            "network");
 
-  if (oaManager->lastError()) {
-    emit networkError(QString(tr("Unable to download %1 (Error #%2)."))
-                      .arg(m_downloadingUrl)
-                      .arg(oaManager->lastError()));
+  // Cancelled
+  if (!m_downloadStarted)
     return;
-  }
 
-  QString fn = urlToPath(m_downloadingUrl);
-  QFile* fp = new QFile(fn);
-  if (!fp->open(QIODevice::WriteOnly)) {
-    emit networkError(QString(tr("Could not open file %1 for writing: ")).
-                      arg(fn) + fp->errorString());
+  if (m_timer)
+    m_timer->replyFinished();
+
+  if (TrafficRecorder::active())
+    TrafficRecorder::record("GET", m_downloadingUrl, 0, error, response,
+                            m_timer ? m_timer->elapsed() : -1, QByteArray(),
+                            false);
+
+  if (error || response.isEmpty()) {
+    downloadFailed(QString(tr("Unable to download %1 (Error #%2)."))
+                   .arg(m_downloadingUrl)
+                   .arg(error));
     return;
   }
-  fp->write(response);
-  fp->close();
 
-  QPixmap pix = pixmap(fn);
-  resizeImage(pix, fn);
+  stopRunning();
+  m_downloadStarted = false;
+  m_downloading.remove(m_key);
+
+  RequestTimer* timer = m_timer;
+  m_timer = NULL;
+
+  if (m_traceId >= 0) {
+    TraceLog::asyncEnd("download", "network", m_traceId,
+                       QString("%1 bytes").arg(response.size()));
+    m_traceId = -1;
+  }
+
+  QString fn = urlToPath(m_downloadingUrl);
+  if (!linkDuplicate(response, fn)) {
+    QFile* fp = new QFile(fn);
+    if (!fp->open(QIODevice::WriteOnly)) {
+      emit networkError(QString(tr("Could not open file %1 for writing: ")).
+                        arg(fn) + fp->errorString());
+      return;
+    }
+    fp->write(response);
+    fp->close();
+
+    ProfileScope decodeScope("image decode and resize", "image");
+    QPixmap pix = pixmap(fn);
+    resizeImage(pix, fn);
+  }
+  m_cachedFile = fn;
+  if (timer)
+    timer->mark(PerfStats::Model);
   
   emit fileReady(fn);
   emit fileReady();
+
+  if (timer) {
+    timer->mark(PerfStats::Widgets);
+    timer->finish();
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -227,12 +476,46 @@ void FileDownloader::resizeImage(QPixmap pix, QString fn) {
 
 //------------------------------------------------------------------------------
 
-QString FileDownloader::urlToPath(const QString& url) {
-  static QCryptographicHash hash(QCryptographicHash::Md5);
-  static QStringList knownEndings;
-  if (knownEndings.isEmpty())
-    knownEndings << ".png" << ".jpeg" << ".jpg" << ".gif";
+// If the same contents have already been saved under another name in
+// this session, links fn to that file instead of writing them again.
+bool FileDownloader::linkDuplicate(const QByteArray& data, const QString& fn) {
+#ifdef Q_OS_WIN
+  // Windows shortcuts aren't followed when loading images
+  Q_UNUSED(data);
+  Q_UNUSED(fn);
+  return false;
+#else
+  if (!s_deduplicate)
+    return false;
+
+  QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+  QString existing = s_contentFiles.value(hash);
+  if (existing.isEmpty() || existing == fn || !QFile::exists(existing)) {
+    s_contentFiles.insert(hash, fn);
+    return false;
+  }
+
+  QFile::remove(fn);
+  if (!QFile::link(existing, fn))
+    return false;
 
+  s_duplicates++;
+  s_duplicateBytes += data.size();
+  return true;
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+int FileDownloader::duplicateCount(qint64* bytes) {
+  if (bytes)
+    *bytes = s_duplicateBytes;
+  return s_duplicates;
+}
+
+//------------------------------------------------------------------------------
+
+QString FileDownloader::getCacheDir() {
   if (m_cacheDir.isEmpty()) {
     m_cacheDir = 
 #ifdef QT5
@@ -246,21 +529,74 @@ QString FileDownloader::urlToPath(const QString& url) {
       m_cacheDir = slashify(m_cacheDir);
     m_cacheDir += "pumpa/";
   }
-  QString path = m_cacheDir;
+  return m_cacheDir;
+}
+
+//------------------------------------------------------------------------------
+
+int FileDownloader::diskCacheUsage(qint64* bytes) {
+  QFileInfoList files = QDir(getCacheDir()).entryInfoList(QDir::Files);
+
+  // Links to duplicates would count the same file twice
+  int count = 0;
+  qint64 total = 0;
+  for (int i=0; i<files.count(); i++) {
+    if (files[i].isSymLink())
+      continue;
+    count++;
+    total += files[i].size();
+  }
+
+  if (bytes)
+    *bytes = total;
+  return count;
+}
+
+//------------------------------------------------------------------------------
+
+QString FileDownloader::urlToPath(const QString& url) {
+  static QCryptographicHash hash(QCryptographicHash::Md5);
+  static QStringList knownEndings;
+  if (knownEndings.isEmpty())
+    knownEndings << ".png" << ".jpeg" << ".jpg" << ".gif";
+
+  QString path = getCacheDir();
   QDir d;
   d.mkpath(path);
 
+  QString key = canonicalImageUrl(url);
+
   QString ending;
   for (int i=0; i<knownEndings.count() && ending.isEmpty(); i++)
-    if (url.endsWith(knownEndings[i]))
+    if (key.endsWith(knownEndings[i]))
       ending = knownEndings[i];
   if (ending.isEmpty())
     ending = ".png";
 
   hash.reset();
-  hash.addData(url.toUtf8());
+  hash.addData(key.toUtf8());
 
   QString hashStr = hash.result().toHex();
 
   return path + hashStr + ending;
 }
+
+//------------------------------------------------------------------------------
+
+void WantedDownloads::add(FileDownloader* fd, int priority) {
+  for (int i=0; i<m_downloads.count(); i++)
+    if (m_downloads[i] == fd)
+      return;
+
+  m_downloads.append(fd);
+  fd->want(priority);
+}
+
+//------------------------------------------------------------------------------
+
+void WantedDownloads::clear() {
+  for (int i=0; i<m_downloads.count(); i++)
+    if (m_downloads[i])
+      m_downloads[i]->unwant();
+  m_downloads.clear();
+}
@@ -25,19 +25,39 @@
 #include <QPixmap>
 
 #include "QtKOAuth"
+#include "perfstats.h"
 
 class FileDownloader : public QObject {
   Q_OBJECT
 
 public:
+  // Queued downloads are started in this order
+  enum Priority { AvatarPriority = 0, // avatars of rows on screen
+                  InlinePriority,     // images in the text of notes
+                  ImagePriority,      // full-size images
+                  NumPriorities };
+
   static void setOAuthInfo(QString siteUrl,
                            QString clientId, QString clientSecret,
                            QString token, QString tokenSecret);
 
+  // With download, the file is downloaded if it isn't in the cache,
+  // and the download is never cancelled.
   static FileDownloader* get(const QString& url, bool download=false);
 
   void download();
 
+  // Removes the download from the queue, or aborts it if it's
+  // running. download() starts it again.
+  void cancel();
+
+  // Counts the widgets waiting for the file, the download is queued
+  // when the first one wants it and cancelled when the last one
+  // doesn't want it any more. See WantedDownloads. The download gets
+  // the highest priority it has been wanted with.
+  void want(int priority = ImagePriority);
+  void unwant();
+
   bool downloading() const { return m_downloadStarted; }
 
   bool ready() const { return !m_cachedFile.isEmpty(); }
@@ -45,8 +65,31 @@ public:
   QString fileName(QString defaultImage) const;
   QPixmap pixmap(QString defaultImage=":/images/broken_image.png") const;
 
-  static QString getCacheDir() { return m_cacheDir; }
+  static QString getCacheDir();
+
+  // Number of files in the disk cache and their total size in bytes.
+  static int diskCacheUsage(qint64* bytes);
+
+  // Number of downloads running, at most MAX_DOWNLOADS, and waiting
+  // in the queue.
+  static int downloadingCount() { return s_running; }
+  static int queuedCount();
+
+  // Number of downloads cancelled so far.
+  static int cancelledCount() { return s_cancelled; }
+
+  // When on, a downloaded file with the same contents as one saved
+  // earlier is stored as a link to that file. Not on Windows.
+  static void setDeduplicate(bool on) { s_deduplicate = on; }
+
+  // Number of files stored as links and the bytes that saved.
+  static int duplicateCount(qint64* bytes);
+
+  // When offline, download() does nothing and files not already in
+  // the cache stay unavailable.
+  static void setOffline(bool offline) { s_offline = offline; }
   
+  // Path of the cached file, named after canonicalImageUrl(url)
   static QString urlToPath(const QString& url);
   
 signals:
@@ -55,28 +98,59 @@ signals:
   void fileReady();
 
 private slots:
-  void onAuthorizedRequestReady(QByteArray response, int id);
+  void onAuthorizedRequestReady(QByteArray response, int id,
+                                KQOAuthManager::KQOAuthError error);
   void onSslErrors(QNetworkReply* reply, const QList<QSslError>&);
   void replyFinished(QNetworkReply* nr);
+  void startNext();
+  void retry();
 
 private:
   FileDownloader();
   FileDownloader(const QString&);
 
+  void enqueue();
+  void start();
+  void stopRunning();
+  void setPriority(int priority);
+  void downloadFailed(QString msg);
+
+  static void startQueued();
+
   static void resizeImage(QPixmap pix, QString fn);
+  static bool linkDuplicate(const QByteArray& data, const QString& fn);
 
   KQOAuthManager *oaManager;
   KQOAuthRequest *oaRequest;
   QNetworkAccessManager* m_nam;
 
   QString m_downloadingUrl;
+  QString m_key;
   QString m_cachedFile;
+  RequestTimer* m_timer;
+  QPointer<QNetworkReply> m_reply;
+  qint64 m_traceId;
 
   bool m_downloadStarted;
+  bool m_running;
+  int m_wanted;
+  int m_priority;
+  int m_retries;
+  QTimer* m_retryTimer;
 
   static QString m_cacheDir;
   static QMap<QString, FileDownloader*> m_downloading;
 
+  static bool s_offline;
+  static int s_cancelled;
+  static int s_running;
+  static QList<FileDownloader*> s_queue[NumPriorities];
+
+  static bool s_deduplicate;
+  static QHash<QByteArray, QString> s_contentFiles;
+  static int s_duplicates;
+  static qint64 s_duplicateBytes;
+
   static QString s_siteUrl;
   static QString s_clientId;
   static QString s_clientSecret;
@@ -84,4 +158,27 @@ private:
   static QString s_tokenSecret;
 };
 
+//------------------------------------------------------------------------------
+
+/*
+  The downloads a widget is waiting for. Each FileDownloader added is
+  wanted until the set is cleared or destroyed, which cancels the
+  downloads no other widget is waiting for.
+*/
+class WantedDownloads {
+public:
+  WantedDownloads() {}
+  ~WantedDownloads() { clear(); }
+
+  void add(FileDownloader* fd,
+           int priority = FileDownloader::ImagePriority);
+  void clear();
+
+private:
+  WantedDownloads(const WantedDownloads&);
+  WantedDownloads& operator=(const WantedDownloads&);
+
+  QList<QPointer<FileDownloader> > m_downloads;
+};
+
 #endif
@@ -21,19 +21,75 @@
 #include "pumpa_defines.h"
 #include "util.h"
 #include "shortobjectwidget.h"
+#include "tracelog.h"
 
 #include <QDesktopServices>
 #include <QMessageBox>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutexLocker>
 
 //------------------------------------------------------------------------------
 
 QSet<QString> s_allowedTags;
 
+QHash<QString, FullObjectWidget::FilteredText> FullObjectWidget::s_textCache;
+QSet<QString> FullObjectWidget::s_textQueued;
+QMutex FullObjectWidget::s_filteredMutex;
+QList<QPair<QString, FullObjectWidget::FilteredText> >
+FullObjectWidget::s_filtered;
+
+// Cleared when it grows larger than this
+#define TEXT_CACHE_MAX_ITEMS 2000
+
+// Texts per thread pool task, small so that the ones at the top of
+// the timeline, which get widgets first, are ready first.
+#define TEXT_TASK_ITEMS 8
+
+//------------------------------------------------------------------------------
+
+// Must be called on the GUI thread before any filterHtml() calls.
+static void initAllowedTags() {
+  if (!s_allowedTags.isEmpty())
+    return;
+
+  s_allowedTags 
+    << "br" << "p" << "b" << "i" << "blockquote" << "div" << "abbr"
+    << "code" << "h1" << "h2" << "h3" << "h4" << "h5"
+    << "em" << "ol" << "li" << "ul" << "hr" << "strong" << "u";
+  s_allowedTags << "pre";
+  s_allowedTags << "a";
+  s_allowedTags << "img";
+}
+
+//------------------------------------------------------------------------------
+
+// Filters texts and leaves the results for takeFilteredText().
+class FilterTask : public QRunnable {
+public:
+  FilterTask(const QStringList& texts) : m_texts(texts) {}
+
+  void run() {
+    ProfileScope profileScope("FilterTask", "text");
+    QList<QPair<QString, FullObjectWidget::FilteredText> > out;
+    for (int i=0; i<m_texts.count(); i++)
+      out << qMakePair(m_texts[i], FullObjectWidget::filterHtml(m_texts[i]));
+
+    QMutexLocker locker(&FullObjectWidget::s_filteredMutex);
+    FullObjectWidget::s_filtered += out;
+  }
+
+private:
+  QStringList m_texts;
+};
+
 //------------------------------------------------------------------------------
 
 FullObjectWidget::FullObjectWidget(QASObject* obj, QWidget* parent,
                                    bool childWidget) :
   ObjectWidgetWithSignals(parent),
+  m_imagesMissing(false),
+  m_imageLabel(NULL),
   m_infoLabel(NULL),
   m_likesLabel(NULL),
   m_sharesLabel(NULL),
@@ -48,7 +104,11 @@ FullObjectWidget::FullObjectWidget(QASObject* obj, QWidget* parent,
   m_object(NULL),
   m_actor(NULL),
   m_author(NULL),
-  m_childWidget(childWidget)
+  m_childWidget(childWidget),
+  m_repliesPending(false),
+  m_firstShown(0),
+  m_threadExpanded(!childWidget),
+  m_showAfterFetch(false)
 {
 #ifdef DEBUG_WIDGETS
   qDebug() << "Creating FullObjectWidget";
@@ -59,13 +119,8 @@ FullObjectWidget::FullObjectWidget(QASObject* obj, QWidget* parent,
   m_contentLayout = new QVBoxLayout;
   m_contentLayout->setContentsMargins(0, 0, 0, 0);
 
-  m_titleLabel = new QLabel(this); 
-  m_contentLayout->addWidget(m_titleLabel);
-
-  m_imageLabel = new ImageLabel(this);
-  connect(m_imageLabel, SIGNAL(clicked()), this, SLOT(imageClicked()));
-  m_imageLabel->setCursor(Qt::PointingHandCursor);
-  m_contentLayout->addWidget(m_imageLabel);
+  // The title and image labels, the buttons and the replies are
+  // created only when needed, most items never show all of them.
 
   m_textLabel = new RichTextLabel(this);
   connect(m_textLabel, SIGNAL(linkHovered(const QString&)),
@@ -79,6 +134,41 @@ FullObjectWidget::FullObjectWidget(QASObject* obj, QWidget* parent,
 
   m_buttonLayout = new QHBoxLayout;
 
+  m_commentsLayout = new QVBoxLayout;
+
+  rightLayout->addLayout(m_contentLayout);
+  rightLayout->addLayout(m_buttonLayout);
+  rightLayout->addLayout(m_commentsLayout);
+
+  // If this object is not an actor itself, show the author in the
+  // avatar image.
+  m_actorWidget = new ActorWidget(NULL, this);
+
+  QHBoxLayout* acrossLayout = new QHBoxLayout;
+  acrossLayout->setSpacing(10);
+  acrossLayout->addWidget(m_actorWidget, 0, Qt::AlignTop);
+  acrossLayout->addLayout(rightLayout);
+
+  changeObject(obj);
+  setSizePolicy(QSizePolicy::Ignored, QSizePolicy::MinimumExpanding);
+  
+  setLayout(acrossLayout);
+}
+
+//------------------------------------------------------------------------------
+
+FullObjectWidget::~FullObjectWidget() {
+#ifdef DEBUG_WIDGETS
+  qDebug() << "Deleting FullObjectWidget" << m_object->id();
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+void FullObjectWidget::createButtons() {
+  if (m_favourButton)
+    return;
+
   m_favourButton = new TextToolButton(this);
   connect(m_favourButton, SIGNAL(clicked()), this, SLOT(favourite()));
   m_buttonLayout->addWidget(m_favourButton, 0, Qt::AlignTop);
@@ -105,34 +195,17 @@ FullObjectWidget::FullObjectWidget(QASObject* obj, QWidget* parent,
   m_buttonLayout->addWidget(m_followButton, 0, Qt::AlignTop);
 
   m_buttonLayout->addStretch();
-
-  m_commentsLayout = new QVBoxLayout;
-
-  rightLayout->addLayout(m_contentLayout);
-  rightLayout->addLayout(m_buttonLayout);
-  rightLayout->addLayout(m_commentsLayout);
-
-  // If this object is not an actor itself, show the author in the
-  // avatar image.
-  m_actorWidget = new ActorWidget(NULL, this);
-
-  QHBoxLayout* acrossLayout = new QHBoxLayout;
-  acrossLayout->setSpacing(10);
-  acrossLayout->addWidget(m_actorWidget, 0, Qt::AlignTop);
-  acrossLayout->addLayout(rightLayout);
-
-  changeObject(obj);
-  setSizePolicy(QSizePolicy::Ignored, QSizePolicy::MinimumExpanding);
-  
-  setLayout(acrossLayout);
 }
 
 //------------------------------------------------------------------------------
 
-FullObjectWidget::~FullObjectWidget() {
-#ifdef DEBUG_WIDGETS
-  qDebug() << "Deleting FullObjectWidget" << m_object->id();
-#endif
+void FullObjectWidget::showEvent(QShowEvent* event) {
+  ObjectWidgetWithSignals::showEvent(event);
+
+  if (m_repliesPending && m_object) {
+    m_repliesPending = false;
+    updateReplies();
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -148,33 +221,44 @@ void FullObjectWidget::changeObject(QASAbstractObject* obj) {
       disconnect(ol, SIGNAL(changed()), this, SLOT(onChanged()));
 
     clearObjectList();
+    m_downloads.clear();
   }
 
   m_object = qobject_cast<QASObject*>(obj);
   if (!m_object)
     return;
 
-  const QString objType = m_object->type();
+  const int objType = m_object->typeId();
 
   connect(m_object, SIGNAL(changed()), this, SLOT(onChanged()));
 
-  if (objType == "comment") {
+  if (objType == QASObject::CommentType) {
     setLineWidth(1);
     setFrameStyle(QFrame::StyledPanel | QFrame::Plain);
   }
 
   if (!m_object->displayName().isEmpty()) {
+    if (!m_titleLabel) {
+      m_titleLabel = new QLabel(this); 
+      m_contentLayout->insertWidget(0, m_titleLabel);
+    }
     m_titleLabel->setText("<b>" + m_object->displayName() + "</b>");
     m_titleLabel->setVisible(true);
-  } else {
+  } else if (m_titleLabel) {
     m_titleLabel->setVisible(false);
   }
 
-  if (objType == "image") {
+  if (objType == QASObject::ImageType) {
+    if (!m_imageLabel) {
+      m_imageLabel = new ImageLabel(this);
+      connect(m_imageLabel, SIGNAL(clicked()), this, SLOT(imageClicked()));
+      m_imageLabel->setCursor(Qt::PointingHandCursor);
+      m_contentLayout->insertWidget(m_titleLabel ? 1 : 0, m_imageLabel);
+    }
     m_imageLabel->setVisible(true);
     m_imageUrl = m_object->imageUrl();
     updateImage();
-  } else {
+  } else if (m_imageLabel) {
     m_imageLabel->setVisible(false);
   }
 
@@ -183,24 +267,20 @@ void FullObjectWidget::changeObject(QASAbstractObject* obj) {
     connect(m_author, SIGNAL(changed()),
             this, SLOT(updateFollowAuthorButton()));
   
-  m_commentable = objType == "note" || objType == "comment" ||
-    objType == "image";
-  if (m_commentable) {
-    m_favourButton->setVisible(true);
-    m_followAuthorButton->setVisible(true);
-    m_shareButton->setVisible(true);
-    m_deleteButton->setVisible(m_author && m_author->isYou());
-    m_commentButton->setVisible(true);
-  } else {
-    m_favourButton->setVisible(false);
-    m_followAuthorButton->setVisible(false);
-    m_shareButton->setVisible(false);
-    m_deleteButton->setVisible(false);
-    m_commentButton->setVisible(false);
+  m_commentable = objType == QASObject::NoteType ||
+    objType == QASObject::CommentType || objType == QASObject::ImageType;
+  if (m_commentable || objType == QASObject::PersonType)
+    createButtons();
+
+  if (m_favourButton) {
+    m_favourButton->setVisible(m_commentable);
+    m_followAuthorButton->setVisible(m_commentable);
+    m_shareButton->setVisible(m_commentable);
+    m_deleteButton->setVisible(m_commentable && m_author && m_author->isYou());
+    m_commentButton->setVisible(m_commentable);
+    m_followButton->setVisible(objType == QASObject::PersonType);
   }
 
-  m_followButton->setVisible(objType == "person");
-
   m_actor = m_object->asActor();
 
   QASActor* actorOrAuthor = m_actor ? m_actor : m_author;
@@ -227,30 +307,22 @@ void FullObjectWidget::onChanged() {
 
   updateFavourButton();
   updateShareButton();
-  m_commentButton->setVisible(m_commentable && 
-                              (m_object->type() != "comment" ||
-                               hasValidIrtObject()));
+  if (m_commentButton)
+    m_commentButton->setVisible(m_commentable && 
+                                (m_object->typeId() != QASObject::CommentType ||
+                                 hasValidIrtObject()));
   updateFollowButton();
   updateFollowAuthorButton();
 
-  QString text = m_object->content();
-  if (m_actor) {
-    text = m_actor->summary();
-    if (text.isEmpty())
-      text = tr("[No description]");
-  }
-
-  setText(processText(text, true));
+  setText(processText(displayText(m_object), true));
 
   updateInfoText();
 
   QASObjectList* ol = m_object->replies();
-  if (ol) {
+  if (ol)
     connect(ol, SIGNAL(changed()), this, SLOT(onChanged()),
             Qt::UniqueConnection);
-    if (ol->size() > 0)
-      addObjectList(ol);
-  }
+  updateReplies();
 }
 
 //------------------------------------------------------------------------------
@@ -315,7 +387,7 @@ bool FullObjectWidget::isFollowable(QASObject* obj) const {
     return false;
 
   QASActor* actor = obj->asActor();
-  return obj->type() == "person" && actor && !actor->isYou();
+  return obj->typeId() == QASObject::PersonType && actor && !actor->isYou();
 }
 
 //------------------------------------------------------------------------------
@@ -357,14 +429,39 @@ void FullObjectWidget::updateFollowAuthorButton(bool /*wait*/) {
 //------------------------------------------------------------------------------
 
 void FullObjectWidget::updateImage() {
-  FileDownloader* fd = FileDownloader::get(m_imageUrl, true);
+  if (!m_imageLabel)
+    return;
+
+  FileDownloader* fd = FileDownloader::get(m_imageUrl);
   connect(fd, SIGNAL(fileReady()), this, SLOT(updateImage()),
           Qt::UniqueConnection);
+  if (!fd->ready()) {
+    m_imagesMissing = true;
+    if (imagesWanted(this))
+      m_downloads.add(fd);
+  }
   m_imageLabel->setPixmap(fd->pixmap(":/images/broken_image.png"));
 }    
 
 //------------------------------------------------------------------------------
 
+void FullObjectWidget::updateImages() {
+  if (!imagesWanted(this)) {
+    m_downloads.clear();
+    return;
+  }
+
+  if (!m_object || !m_imagesMissing)
+    return;
+
+  // Shows the ones that have arrived meanwhile, and starts the rest
+  m_imagesMissing = false;
+  updateImage();
+  setText(processText(displayText(m_object), true));
+}
+
+//------------------------------------------------------------------------------
+
 void FullObjectWidget::updateLikes() {
   size_t nl = m_object->numLikes();
 
@@ -447,65 +544,120 @@ void FullObjectWidget::imageClicked() {
 
 //------------------------------------------------------------------------------
 
-void FullObjectWidget::addObjectList(QASObjectList* ol) {
-  int li = 0; // index where to insert next widget in the layout
-  int li_before = li;
-  if (m_hasMoreButton != NULL)
-    li++;
+static bool sortIntLessThan(const QASObject* a, const QASObject* b) {
+  return a->sortInt() < b->sortInt();
+}
+
+//------------------------------------------------------------------------------
 
+void FullObjectWidget::updateReplies() {
+  QASObjectList* ol = m_object->replies();
+  if (!ol || ol->size() == 0)
+    return;
+
+  if (!isVisible())
+    m_repliesPending = true;
+  else if (m_threadExpanded)
+    addObjectList(ol);
+  else
+    updateHasMoreButton(ol);
+}
+
+//------------------------------------------------------------------------------
+
+void FullObjectWidget::addObjectList(QASObjectList* ol) {
   /*
-    For now we sort by time, or more accurately by whatever number the
+    We sort by time, or more accurately by whatever number the
     QASObject::sortInt() returns. Higher number is newer, goes further
     down the list.
-  
-    Comments' lists returned by the pump API are with newest at the
-    top, so we start from the end, and can assume that the next one is
-    always newer.
+
+    All replies we know of are in m_repliesList, but only the ones
+    from m_firstShown onwards have widgets. The older ones are shown
+    REPLIES_PAGE_SIZE at a time with the button at the top.
   */
+  bool initial = m_repliesList.isEmpty();
 
-  int i = 0; // index into m_repliesList
   for (size_t j=0; j<ol->size(); j++) {
-    QASObject* replyObj = ol->at(ol->size()-j-1);
+    QASObject* replyObj = ol->at(j);
     QString replyId = replyObj->id();
-    qint64 sortInt = replyObj->sortInt();
-
-    while (i < m_repliesList.size() &&
-           m_repliesList[i]->id() != replyId &&
-           m_repliesList[i]->sortInt() < sortInt)
-      i++;
-
     if (m_repliesMap.contains(replyId))
       continue;
 
-    if (i < m_repliesList.size() && m_repliesList[i]->id() == replyId)
-      continue;
-
-    FullObjectWidget* ow = new FullObjectWidget(replyObj, this, true);
-    ObjectWidgetWithSignals::connectSignals(ow, this);
+    int i = qUpperBound(m_repliesList.begin(), m_repliesList.end(),
+                        replyObj, sortIntLessThan) - m_repliesList.begin();
+    bool older = i <= m_firstShown && m_firstShown < m_repliesList.size();
 
-    m_commentsLayout->insertWidget(li + i, ow);
     m_repliesList.insert(i, replyObj);
     m_repliesMap.insert(replyId);
+
+    if (initial)
+      continue;
+    if (older)
+      m_firstShown++;
+    else
+      addReplyWidget(i);
   }
 
-  if (ol->hasMore() && (qulonglong)m_repliesList.size() < ol->totalItems()) {
-    addHasMoreButton(ol, li_before);
-  } else if (m_hasMoreButton != NULL) {
-    m_commentsLayout->removeWidget(m_hasMoreButton);
-    delete m_hasMoreButton;
-    m_hasMoreButton = NULL;
+  if (initial) {
+    m_firstShown = qMax(0, m_repliesList.size() - REPLIES_PAGE_SIZE);
+    for (int i=m_firstShown; i<m_repliesList.size(); i++)
+      addReplyWidget(i);
   }
+
+  if (m_showAfterFetch) {
+    m_showAfterFetch = false;
+    showEarlierReplies();
+  }
+
+  updateHasMoreButton(ol);
 }
 
 //------------------------------------------------------------------------------
 
-void FullObjectWidget::addHasMoreButton(QASObjectList* ol, int li) {
-  QString buttonText = QString(tr("Show all %1 replies")).
-    arg(ol->totalItems());
+void FullObjectWidget::addReplyWidget(int i) {
+  FullObjectWidget* ow = new FullObjectWidget(m_repliesList[i], this, true);
+  ObjectWidgetWithSignals::connectSignals(ow, this);
+
+  int li = (m_hasMoreButton ? 1 : 0) + i - m_firstShown;
+  m_commentsLayout->insertWidget(li, ow);
+}
+
+//------------------------------------------------------------------------------
+
+void FullObjectWidget::showEarlierReplies() {
+  int first = qMax(0, m_firstShown - REPLIES_PAGE_SIZE);
+  while (m_firstShown > first)
+    addReplyWidget(--m_firstShown);
+}
+
+//------------------------------------------------------------------------------
+
+void FullObjectWidget::updateHasMoreButton(QASObjectList* ol) {
+  QString buttonText;
+  if (!m_threadExpanded)
+    buttonText = QString(tr("Show %1 replies")).
+      arg(qMax(ol->totalItems(), (qulonglong)ol->size()));
+  else if (m_firstShown > 0)
+    buttonText = QString(tr("Show %1 earlier replies")).
+      arg(qMin(m_firstShown, REPLIES_PAGE_SIZE));
+  else if (ol->hasMore() && (qulonglong)m_repliesList.size() < ol->totalItems())
+    buttonText = QString(tr("Show all %1 replies")).arg(ol->totalItems());
+
+  if (buttonText.isEmpty()) {
+    if (m_hasMoreButton != NULL) {
+      // might be called from its clicked() signal
+      m_commentsLayout->removeWidget(m_hasMoreButton);
+      m_hasMoreButton->hide();
+      m_hasMoreButton->deleteLater();
+      m_hasMoreButton = NULL;
+    }
+    return;
+  }
+
   if (m_hasMoreButton == NULL) {
     m_hasMoreButton = new QPushButton(this);
     m_hasMoreButton->setFocusPolicy(Qt::NoFocus);
-    m_commentsLayout->insertWidget(li, m_hasMoreButton);
+    m_commentsLayout->insertWidget(0, m_hasMoreButton);
     connect(m_hasMoreButton, SIGNAL(clicked()), 
             this, SLOT(onHasMoreClicked()));
   }
@@ -516,8 +668,17 @@ void FullObjectWidget::addHasMoreButton(QASObjectList* ol, int li) {
 //------------------------------------------------------------------------------
 
 void FullObjectWidget::onHasMoreClicked() {
-  m_hasMoreButton->setText("...");
-  refreshObject(m_object->replies());
+  if (!m_threadExpanded) {
+    m_threadExpanded = true;
+    updateReplies();
+  } else if (m_firstShown > 0) {
+    showEarlierReplies();
+    updateHasMoreButton(m_object->replies());
+  } else {
+    m_hasMoreButton->setText("...");
+    m_showAfterFetch = true;
+    refreshObject(m_object->replies());
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -591,16 +752,58 @@ void FullObjectWidget::onFollowAuthor() {
 //------------------------------------------------------------------------------
 
 QString FullObjectWidget::processText(QString old_text, bool getImages) {
-  if (s_allowedTags.isEmpty()) {
-    s_allowedTags 
-      << "br" << "p" << "b" << "i" << "blockquote" << "div" << "abbr"
-      << "code" << "h1" << "h2" << "h3" << "h4" << "h5"
-      << "em" << "ol" << "li" << "ul" << "hr" << "strong" << "u";
-    s_allowedTags << "pre";
-    s_allowedTags << "a";
-    s_allowedTags << "img";
+  ProfileScope profileScope("FullObjectWidget::processText", "text");
+
+  takeFilteredText();
+
+  FilteredText ft;
+  QHash<QString, FilteredText>::const_iterator it =
+    s_textCache.constFind(old_text);
+  if (it != s_textCache.constEnd()) {
+    ft = it.value();
+  } else {
+    initAllowedTags();
+    ft = filterHtml(old_text);
   }
-  
+
+  // The downloads and signal connections have to be done here on the
+  // GUI thread.
+  QString text = ft.html;
+  for (int i=0; i<ft.images.count(); i++) {
+    QString imagePlaceholder = "[image]";
+
+    if (getImages) {
+      const QString& imgSrc = ft.images[i];
+      FileDownloader* fd = FileDownloader::get(imgSrc);
+      connect(fd, SIGNAL(fileReady()), this, SLOT(onChanged()),
+              Qt::UniqueConnection);
+      if (fd->ready()) {
+        imagePlaceholder = 
+          QString("<a href=\"%2\"><img border=\"0\" src=\"%1\" /></a>").
+          arg(fd->fileName()).arg(imgSrc);
+      } else {
+        m_imagesMissing = true;
+        if (imagesWanted(this))
+          m_downloads.add(fd, FileDownloader::InlinePriority);
+      }
+    }
+    text.replace(imageToken(i), imagePlaceholder);
+  }
+
+  return text;
+}
+
+//------------------------------------------------------------------------------
+
+QString FullObjectWidget::imageToken(int i) {
+  return QString(QChar(0xFFFC)) + QString::number(i) + QChar(0xFFFC);
+}
+
+//------------------------------------------------------------------------------
+
+// Only does string processing, so it's safe to call from other threads.
+FullObjectWidget::FilteredText FullObjectWidget::filterHtml(QString old_text) {
+  FilteredText ft;
   QString text = old_text.trimmed();
   int pos;
 
@@ -635,21 +838,11 @@ QString FullObjectWidget::processText(QString old_text, bool getImages) {
     if (tag == "img") { // Replace img's with placeholder
       QString imagePlaceholder = "[image]";
 
-      if (getImages) {
-        QRegExp rxi("\\s+src=\"?(" URL_REGEX ")\"?");
-        int spos = rxi.indexIn(inside);
-        if (spos != -1) {
-          QString imgSrc = rxi.cap(1);
-          // qDebug() << "[DEBUG] processText: img" << imgSrc;
-          
-          FileDownloader* fd = FileDownloader::get(imgSrc, true);
-          connect(fd, SIGNAL(fileReady()), this, SLOT(onChanged()),
-                  Qt::UniqueConnection);
-          if (fd->ready())
-            imagePlaceholder = 
-              QString("<a href=\"%2\"><img border=\"0\" src=\"%1\" /></a>").
-              arg(fd->fileName()).arg(imgSrc);
-        }
+      QRegExp rxi("\\s+src=\"?(" URL_REGEX ")\"?");
+      int spos = rxi.indexIn(inside);
+      if (spos != -1) {
+        imagePlaceholder = imageToken(ft.images.count());
+        ft.images << rxi.cap(1);
       }
       text.replace(pos, len, imagePlaceholder);
       pos += imagePlaceholder.length();
@@ -669,11 +862,88 @@ QString FullObjectWidget::processText(QString old_text, bool getImages) {
   while (text.endsWith("<br>"))
     text.chop(4);
 
+  ft.html = text;
+  return ft;
+}
+
+//------------------------------------------------------------------------------
+
+QString FullObjectWidget::displayText(QASObject* obj) {
+  QASActor* actor = obj->asActor();
+  if (!actor)
+    return obj->content();
+
+  QString text = actor->summary();
+  if (text.isEmpty())
+    text = tr("[No description]");
   return text;
 }
 
 //------------------------------------------------------------------------------
 
+void FullObjectWidget::precomputeText(const QList<QASObject*>& objs) {
+  takeFilteredText();
+
+  QStringList texts;
+  QSet<QString> seen;
+  for (int i=0; i<objs.count(); i++) {
+    QList<QASObject*> todo;
+    todo << objs[i];
+    // only the newest replies get widgets at first, and the lists
+    // from the server are newest first
+    QASObjectList* replies = objs[i]->replies();
+    for (size_t j=0; replies && j<replies->size() && j<REPLIES_PAGE_SIZE; j++)
+      todo << replies->at(j);
+
+    for (int j=0; j<todo.count(); j++) {
+      QString text = displayText(todo[j]);
+      if (!text.isEmpty() && !seen.contains(text) &&
+          !s_textCache.contains(text) && !s_textQueued.contains(text)) {
+        seen.insert(text);
+        texts << text;
+      }
+    }
+  }
+
+  // Not worth the trouble for a few notes
+  if (texts.count() < 4)
+    return;
+
+  ProfileScope profileScope("FullObjectWidget::precomputeText", "text");
+
+  // QCoreApplication waits for the global pool when it is destroyed,
+  // so no task outlives the statics it uses.
+  QThreadPool* pool = QThreadPool::globalInstance();
+  initAllowedTags();
+
+  for (int i=0; i<texts.count(); i++)
+    s_textQueued.insert(texts[i]);
+  for (int i=0; i<texts.count(); i+=TEXT_TASK_ITEMS)
+    pool->start(new FilterTask(texts.mid(i, TEXT_TASK_ITEMS)));
+}
+
+//------------------------------------------------------------------------------
+
+void FullObjectWidget::takeFilteredText() {
+  QList<QPair<QString, FilteredText> > filtered;
+  {
+    QMutexLocker locker(&s_filteredMutex);
+    if (s_filtered.isEmpty())
+      return;
+    filtered = s_filtered;
+    s_filtered.clear();
+  }
+
+  if (s_textCache.count() + filtered.count() > TEXT_CACHE_MAX_ITEMS)
+    s_textCache.clear();
+  for (int i=0; i<filtered.count(); i++) {
+    s_textCache.insert(filtered[i].first, filtered[i].second);
+    s_textQueued.remove(filtered[i].first);
+  }
+}
+
+//------------------------------------------------------------------------------
+
 void FullObjectWidget::clearObjectList() {
   QLayoutItem* item;
   while ((item = m_commentsLayout->takeAt(0)) != 0) {
@@ -691,6 +961,9 @@ void FullObjectWidget::clearObjectList() {
   m_repliesMap.clear();
   m_repliesList.clear();
   m_hasMoreButton = NULL;
+  m_repliesPending = false;
+  m_firstShown = 0;
+  m_showAfterFetch = false;
 }
 
 //------------------------------------------------------------------------------
@@ -24,6 +24,10 @@
 #include <QWidget>
 #include <QVBoxLayout>
 #include <QPushButton>
+#include <QHash>
+#include <QStringList>
+#include <QMutex>
+#include <QPair>
 
 #include "objectwidgetwithsignals.h"
 #include "qactivitystreams.h"
@@ -47,6 +51,20 @@ public:
   virtual QASAbstractObject* asObject() const { return object(); }
 
   virtual void refreshTimeLabels();
+  // Filters and shortens the HTML of a note for display. With
+  // getImages, inline images are downloaded and shown.
+  QString processText(QString old_text, bool getImages=false);
+
+  // Starts the string processing part of processText() for the texts
+  // of objs, and their newest replies, on a thread pool. Doesn't wait
+  // for it: the results are cached as they come, and a widget created
+  // before its text is done filters it itself.
+  static void precomputeText(const QList<QASObject*>& objs);
+
+  virtual void updateImages();
+
+protected:
+  virtual void showEvent(QShowEvent* event);
 
 private slots:
   void onChanged();
@@ -63,6 +81,31 @@ private slots:
   void onDeleteClicked();
 
 private:
+  // The text of a note with the HTML filtered, and the inline images
+  // replaced by imageToken(i), where i indexes images.
+  struct FilteredText {
+    QString html;
+    QStringList images;
+  };
+
+  static FilteredText filterHtml(QString text);
+  static QString imageToken(int i);
+  static QString displayText(QASObject* obj);
+
+  // Moves the texts filtered by the thread pool to s_textCache.
+  static void takeFilteredText();
+
+  static QHash<QString, FilteredText> s_textCache;
+
+  // Texts given to the thread pool and not yet in s_textCache.
+  static QSet<QString> s_textQueued;
+
+  // Filled by the pool threads, emptied on the GUI thread.
+  static QMutex s_filteredMutex;
+  static QList<QPair<QString, FilteredText> > s_filtered;
+  friend class FilterTask;
+
+  void createButtons();
   bool hasValidIrtObject();
   void setText(QString text);
   void updateInfoText();
@@ -71,9 +114,11 @@ private:
   void updateShares();
 
   QString recipientsToString(QASObjectList* rec);
-  QString processText(QString old_text, bool getImages=false);
 
-  void addHasMoreButton(QASObjectList* ol, int li);
+  void updateReplies();
+  void addReplyWidget(int i);
+  void showEarlierReplies();
+  void updateHasMoreButton(QASObjectList* ol);
   void updateFavourButton(bool wait = false);
   void updateShareButton(bool wait = false);
   void updateFollowButton(bool wait = false);
@@ -86,6 +131,11 @@ private:
   QString m_imageUrl;
   QString m_localFile;
 
+  // Downloads of the image and inline images, and whether any of
+  // them wasn't in the cache when last shown.
+  WantedDownloads m_downloads;
+  bool m_imagesMissing;
+
   RichTextLabel* m_textLabel;
   ImageLabel* m_imageLabel;
   ActorWidget* m_actorWidget;
@@ -116,6 +166,14 @@ private:
 
   bool m_childWidget;
   bool m_commentable;
+  bool m_repliesPending;
+
+  // Index of the oldest reply in m_repliesList that has a widget
+  int m_firstShown;
+
+  // Sub-threads, i.e. replies to replies, start collapsed
+  bool m_threadExpanded;
+  bool m_showAfterFetch;
 };
 
 #endif /* _FULLOBJECTWIDGET_H_ */
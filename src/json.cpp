@@ -68,6 +68,115 @@ const char* serializeJsonC(QVariantMap json) {
 
 //------------------------------------------------------------------------------
 
+static inline void fnvAdd(quint64& h, const void* data, int len) {
+  const uchar* p = static_cast<const uchar*>(data);
+  for (int i=0; i<len; i++) {
+    h ^= p[i];
+    h *= Q_UINT64_C(1099511628211);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+static inline void fnvAdd(quint64& h, const QString& s) {
+  int len = s.size();
+  fnvAdd(h, &len, sizeof(len));
+  fnvAdd(h, s.constData(), len*sizeof(QChar));
+}
+
+//------------------------------------------------------------------------------
+
+/*
+  Maps are hashed from the fingerprints of their values, so each
+  nested value is only hashed once however deep it is. With fps, the
+  fingerprints of the maps that have an "id" are collected on the
+  way.
+*/
+static quint64 fingerprint(const QVariant& json, JsonFingerprints* fps) {
+  quint64 h = Q_UINT64_C(14695981039346656037);
+  int type = json.type();
+  fnvAdd(h, &type, sizeof(type));
+
+  switch (type) {
+  case QVariant::Map: {
+    const QVariantMap map = json.toMap();
+    for (QVariantMap::const_iterator it = map.constBegin();
+         it != map.constEnd(); ++it) {
+      fnvAdd(h, it.key());
+      quint64 child = fingerprint(it.value(), fps);
+      fnvAdd(h, &child, sizeof(child));
+    }
+
+    QVariantMap::const_iterator it = map.constFind("id");
+    if (fps && it != map.constEnd()) {
+      // An id seen with different contents gets 0, i.e. unknown
+      QString id = it.value().toString();
+      JsonFingerprints::iterator f = fps->find(id);
+      if (f == fps->end())
+        fps->insert(id, h);
+      else if (f.value() != h)
+        f.value() = 0;
+    }
+    break;
+  }
+  case QVariant::List: {
+    const QVariantList list = json.toList();
+    for (int i=0; i<list.count(); i++) {
+      quint64 child = fingerprint(list.at(i), fps);
+      fnvAdd(h, &child, sizeof(child));
+    }
+    break;
+  }
+  case QVariant::Bool: {
+    bool b = json.toBool();
+    fnvAdd(h, &b, sizeof(b));
+    break;
+  }
+  case QVariant::Int:
+  case QVariant::UInt:
+  case QVariant::LongLong:
+  case QVariant::ULongLong: {
+    qlonglong n = json.toLongLong();
+    fnvAdd(h, &n, sizeof(n));
+    break;
+  }
+  case QVariant::Double: {
+    double d = json.toDouble();
+    fnvAdd(h, &d, sizeof(d));
+    break;
+  }
+  default:
+    fnvAdd(h, json.toString());
+  }
+  return h;
+}
+
+//------------------------------------------------------------------------------
+
+quint64 jsonFingerprint(const QVariant& json) {
+  return fingerprint(json, NULL);
+}
+
+//------------------------------------------------------------------------------
+
+void collectJsonFingerprints(const QVariantMap& json, JsonFingerprints& fps) {
+  fingerprint(json, &fps);
+}
+
+//------------------------------------------------------------------------------
+
+quint64 lookupJsonFingerprint(const QVariantMap& json,
+                              const JsonFingerprints* fps) {
+  if (fps) {
+    quint64 fp = fps->value(json.value("id").toString());
+    if (fp)
+      return fp;
+  }
+  return jsonFingerprint(json);
+}
+
+//------------------------------------------------------------------------------
+
 QString debugDumpJson(QVariantMap json, QString name, QString indent) {
   QString ret = "{";
 
@@ -21,6 +21,7 @@
 #define _JSON_H_
 
 #include <QVariantMap>
+#include <QHash>
 
 //------------------------------------------------------------------------------
 
@@ -30,6 +31,27 @@ QByteArray serializeJson(QVariantMap json);
 
 const char* serializeJsonC(QVariantMap json);
 
+/*
+  Computes a 64-bit fingerprint (FNV-1a) of a parsed JSON value,
+  including all nested maps and lists. Used to detect when the same
+  JSON is delivered again.
+*/
+quint64 jsonFingerprint(const QVariant& json);
+
+/*
+  Fingerprints of the maps with an "id" in a response, keyed by the
+  id, so that the expensive part of change detection can run on a
+  worker thread without adding anything to the JSON itself. An id
+  that occurs with different contents in the same response maps to
+  0. lookupJsonFingerprint() returns the collected value for json's
+  id, or computes it if there is none.
+*/
+typedef QHash<QString, quint64> JsonFingerprints;
+
+void collectJsonFingerprints(const QVariantMap& json, JsonFingerprints& fps);
+quint64 lookupJsonFingerprint(const QVariantMap& json,
+                              const JsonFingerprints* fps);
+
 QString debugDumpJson(QVariantMap json, QString name = "",
                       QString indent = "");
 
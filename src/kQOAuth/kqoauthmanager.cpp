@@ -259,38 +259,34 @@ void KQOAuthManager::executeRequest(KQOAuthRequest *request) {
     d->r->requestTimerStart();
 }
 
-void KQOAuthManager::executeAuthorizedRequest(KQOAuthRequest *request, int id) {
+bool KQOAuthManager::executeAuthorizedRequest(KQOAuthRequest *request, int id) {
     Q_D(KQOAuthManager);
 
-    d->r = request;
-
     if (request == 0) {
         qWarning() << "Request is NULL. Cannot proceed.";
         d->error = KQOAuthManager::RequestError;
-        return;
+        return false;
     }
 
     if (!request->requestEndpoint().isValid()) {
         qWarning() << "Request endpoint URL is not valid. Cannot proceed.";
         d->error = KQOAuthManager::RequestEndpointError;
-        return;
+        return false;
     }
 
     if (!request->isValid()) {
         qWarning() << "Request is not valid. Cannot proceed.";
         d->error = KQOAuthManager::RequestValidationError;
-        return;
+        return false;
     }
 
-    d->currentRequestType = request->requestType();
-
     QNetworkRequest networkRequest;
     networkRequest.setUrl( request->requestEndpoint() );
 
-    if ( d->currentRequestType != KQOAuthRequest::AuthorizedRequest){
+    if ( request->requestType() != KQOAuthRequest::AuthorizedRequest){
         qWarning() << "Not Authorized Request. Cannot proceed";
         d->error = KQOAuthManager::RequestError;
-        return;
+        return false;
     }
 
 
@@ -312,10 +308,10 @@ void KQOAuthManager::executeAuthorizedRequest(KQOAuthRequest *request, int id) {
     networkRequest.setRawHeader("Authorization", authHeader);
 
 
+    // Authorized replies are finished through their own finished()
+    // signal, see onAuthorizedReplyFinished().
     disconnect(d->networkManager, SIGNAL(finished(QNetworkReply *)),
             this, SLOT(onRequestReplyReceived(QNetworkReply *)));
-    connect(d->networkManager, SIGNAL(finished(QNetworkReply *)),
-            this, SLOT(onAuthorizedRequestReplyReceived(QNetworkReply*)), Qt::UniqueConnection);
 
     QNetworkReply *reply = NULL;
     if (request->httpMethod() == KQOAuthRequest::GET) {
@@ -337,11 +333,6 @@ void KQOAuthManager::executeAuthorizedRequest(KQOAuthRequest *request, int id) {
 
         // Submit the request including the params.
         reply = d->networkManager->get(networkRequest);
-        connect(reply, SIGNAL(error(QNetworkReply::NetworkError)),
-                 this, SLOT(slotError(QNetworkReply::NetworkError)));
-        connect(request, SIGNAL(requestTimedout()),
-                 this, SLOT(requestTimeout()));
-        d->requestMap.insert( request, reply );
 
     } else if (request->httpMethod() == KQOAuthRequest::POST) {
 
@@ -364,15 +355,27 @@ void KQOAuthManager::executeAuthorizedRequest(KQOAuthRequest *request, int id) {
         } else {
           reply = d->networkManager->post(networkRequest, request->rawData());
         }
+    }
 
-        connect(reply, SIGNAL(error(QNetworkReply::NetworkError)),
-                 this, SLOT(slotError(QNetworkReply::NetworkError)));
-        connect(request, SIGNAL(requestTimedout()),
-                 this, SLOT(requestTimeout()));
-        d->requestMap.insert( request, reply );
+    if (!reply) {
+        qWarning() << "Unsupported HTTP method. Cannot proceed.";
+        d->error = KQOAuthManager::RequestError;
+        return false;
     }
-    d->requestIds.insert(reply, id);
-    d->r->requestTimerStart();
+
+    connect(reply, SIGNAL(finished()),
+            this, SLOT(onAuthorizedReplyFinished()));
+    connect(request, SIGNAL(requestTimedout()),
+            this, SLOT(requestTimeout()));
+
+    KQOAuthRequestState state;
+    state.request = request;
+    state.id = id;
+    d->authorizedReplies.insert(reply, state);
+    d->authorizedRequests.insert(request, reply);
+
+    request->requestTimerStart();
+    return true;
 }
 
 
@@ -542,6 +545,11 @@ void KQOAuthManager::sendAuthorizedRequest(QUrl requestEndpoint, const KQOAuthPa
 void KQOAuthManager::onRequestReplyReceived( QNetworkReply *reply ) {
     Q_D(KQOAuthManager);
 
+    // Authorized requests are finished in onAuthorizedReplyFinished().
+    if (d->authorizedReplies.contains(reply)) {
+        return;
+    }
+
     QNetworkReply::NetworkError networkError = reply->error();
     switch (networkError) {
     case QNetworkReply::NoError:
@@ -620,67 +628,65 @@ void KQOAuthManager::onRequestReplyReceived( QNetworkReply *reply ) {
     reply->deleteLater();           // We need to clean this up, after the event processing is done.
 }
 
+void KQOAuthManager::onAuthorizedReplyFinished() {
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if (reply) {
+        onAuthorizedRequestReplyReceived(reply);
+    }
+}
+
 void KQOAuthManager::onAuthorizedRequestReplyReceived( QNetworkReply *reply ) {
     Q_D(KQOAuthManager);
 
+    if (!d->authorizedReplies.contains(reply)) {
+        return;
+    }
+    KQOAuthRequestState state = d->authorizedReplies.take(reply);
+    d->authorizedRequests.remove(state.request);
+
+    KQOAuthManager::KQOAuthError error = state.error;
     QNetworkReply::NetworkError networkError = reply->error();
     switch (networkError) {
     case QNetworkReply::NoError:
-        d->error = KQOAuthManager::NoError;
         break;
 
     case QNetworkReply::ContentAccessDenied:
     case QNetworkReply::AuthenticationRequiredError:
-        d->error = KQOAuthManager::RequestUnauthorized;
+        error = KQOAuthManager::RequestUnauthorized;
         break;
 
     default:
-        d->error = KQOAuthManager::NetworkError;
+        error = KQOAuthManager::NetworkError;
         break;
     }
 
-    /*
-    disconnect(d->networkManager, SIGNAL(finished(QNetworkReply *)),
-            this, SLOT(onAuthorizedRequestReplyReceived(QNetworkReply *)));
-    */
-
-    // Read the content of the reply from the network.
-    QByteArray networkReply = reply->readAll();
-
-    int id = d->requestIds.take(reply);
-    d->r = d->requestMap.key(reply);
-    if( d->r ) {
-        d->requestMap.remove(d->r);
-        disconnect(d->r, SIGNAL(requestTimedout()),
-                this, SLOT(requestTimeout()));
-
-        // Stop any timer we have set on the request.
-        d->r->requestTimerStop();
-        d->currentRequestType = d->r->requestType();
-    }
+    // Kept for users of lastError(), but with several requests in
+    // flight only the error given in authorizedRequestFinished() is
+    // reliable.
+    d->error = error;
 
+    disconnect(state.request, SIGNAL(requestTimedout()),
+            this, SLOT(requestTimeout()));
 
+    // Stop any timer we have set on the request.
+    state.request->requestTimerStop();
 
-    // Just don't do anything if we didn't get anything useful.
-    if(networkReply.isEmpty()) {
-        reply->deleteLater();
-        return;
-    }
+    // Read the content of the reply from the network.
+    QByteArray networkReply = reply->readAll();
 
-    // We need to emit the signal even if we got an error.
-    if (d->error != KQOAuthManager::NoError) {
+    if (error != KQOAuthManager::NoError) {
         emit errorMessage("Unable to retrieve "+reply->url().toString());
-        return;
+    } else {
+        emit authorizedRequestDone();
     }
 
+    // We need to emit the signal even if we got an error.
+    emit authorizedRequestFinished(networkReply, state.id, error);
 
-    d->opaqueRequest->clearRequest();
-    d->opaqueRequest->setHttpMethod(KQOAuthRequest::POST);   // XXX FIXME: Convenient API does not support GET
-    if (d->currentRequestType == KQOAuthRequest::AuthorizedRequest) {
-                emit authorizedRequestDone();
-     }
+    // The old signal only ever carried successful replies.
+    if (error == KQOAuthManager::NoError)
+        emit authorizedRequestReady(networkReply, state.id);
 
-    emit authorizedRequestReady(networkReply, id);
     reply->deleteLater();
 }
 
@@ -715,11 +721,7 @@ void KQOAuthManager::slotError(QNetworkReply::NetworkError error) {
     d->r = d->requestMap.key(reply);
     d->currentRequestType = d->r ? d->r->requestType() :
       KQOAuthRequest::AuthorizedRequest;
-    if( d->requestIds.contains(reply) ) {
-        int id = d->requestIds.value(reply);
-        emit authorizedRequestReady(emptyResponse, id);
-    }
-    else if ( d->currentRequestType == KQOAuthRequest::AuthorizedRequest) {
+    if ( d->currentRequestType == KQOAuthRequest::AuthorizedRequest) {
         // does this signal always have to be emitted if there is an error
         // or can is it only valid for KQOAuthRequest::AuthorizedRequest?
         emit authorizedRequestDone();
@@ -734,7 +736,13 @@ void KQOAuthManager::slotError(QNetworkReply::NetworkError error) {
 void KQOAuthManager::requestTimeout() {
     Q_D(KQOAuthManager);
     KQOAuthRequest *request = qobject_cast<KQOAuthRequest *>(sender());
-    if( d->requestMap.contains(request)) {
+    if( d->authorizedRequests.contains(request)) {
+        qWarning() << "KQOAuthManager::requestTimeout: Calling abort";
+        d->authorizedReplies[d->authorizedRequests.value(request)].error =
+            KQOAuthManager::NetworkError;
+        d->authorizedRequests.value(request)->abort();
+    }
+    else if( d->requestMap.contains(request)) {
         qWarning() << "KQOAuthManager::requestTimeout: Calling abort";
         d->requestMap.value(request)->abort();
     }
@@ -745,9 +753,8 @@ void KQOAuthManager::requestTimeout() {
 
 QNetworkReply* KQOAuthManager::getReply(KQOAuthRequest* request) {
   Q_D(KQOAuthManager);
-  KQOAuthRequest* tmp = request;
-  if (!d->requestMap.contains(tmp))
-    return NULL;
+  if (d->authorizedRequests.contains(request))
+    return d->authorizedRequests.value(request);
 
-  return d->requestMap.value(request);
+  return d->requestMap.value(request, NULL);
 }
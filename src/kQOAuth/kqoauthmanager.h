@@ -61,7 +61,14 @@ public:
      * NOTE: At the moment there is no timeout for the request.
      */
     void executeRequest(KQOAuthRequest *request);    
-    void executeAuthorizedRequest(KQOAuthRequest *request, int id);
+    /**
+     * Executes an authorized request. Any number of these can be in flight at
+     * the same time, each one is finished with exactly one
+     * authorizedRequestFinished() signal carrying the given id and the error
+     * of that particular request. Returns false, and emits nothing, if the
+     * request could not be sent at all; lastError() then tells why.
+     */
+    bool executeAuthorizedRequest(KQOAuthRequest *request, int id);
     /**
      * Indicates to the user that KQOAuthManager should handle user authorization by
      * opening the user's default browser and parsing the reply from the service.
@@ -149,8 +156,15 @@ Q_SIGNALS:
     // Parameter is the raw response from the service.
     void requestReady(QByteArray networkReply);
 
+    // Emitted only for requests that succeeded, see
+    // authorizedRequestFinished() for all of them.
     void authorizedRequestReady(QByteArray networkReply, int id);
 
+    // Emitted exactly once for each request given to executeAuthorizedRequest(),
+    // with the error of that request.
+    void authorizedRequestFinished(QByteArray networkReply, int id,
+                                   KQOAuthManager::KQOAuthError error);
+
     // This signal will be emited when we have an request tokens available
     // (either temporary resource tokens, or authorization tokens).
     void receivedToken(QString oauth_token, QString oauth_token_secret);   // oauth_token, oauth_token_secret
@@ -178,6 +192,7 @@ Q_SIGNALS:
 private Q_SLOTS:
     void onRequestReplyReceived( QNetworkReply *reply );
     void onAuthorizedRequestReplyReceived( QNetworkReply *reply );
+    void onAuthorizedReplyFinished();
     void onVerificationReceived(QMultiMap<QString, QString> response);
     void slotError(QNetworkReply::NetworkError error);
     void requestTimeout();
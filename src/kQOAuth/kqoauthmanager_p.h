@@ -20,9 +20,21 @@
 #ifndef KQOAUTHMANAGER_P_H
 #define KQOAUTHMANAGER_P_H
 
+#include <QHash>
+
 #include "kqoauthauthreplyserver.h"
+#include "kqoauthmanager.h"
 #include "kqoauthrequest.h"
 
+// State of one authorized request that is in flight.
+struct KQOAuthRequestState {
+    KQOAuthRequestState() : request(0), id(0), error(KQOAuthManager::NoError) {}
+
+    KQOAuthRequest *request;
+    int id;
+    KQOAuthManager::KQOAuthError error;
+};
+
 class KQOAUTH_EXPORT KQOAuthManagerPrivate {
 
 public:
@@ -64,10 +76,13 @@ public:
     bool autoAuth;
     QNetworkAccessManager *networkManager;
     bool managerUserSet;
-    QMap<QNetworkReply*, int> requestIds;
-
     QMap<KQOAuthRequest*, QNetworkReply*> requestMap;
 
+    // Authorized requests in flight, and the reverse mapping for
+    // getReply() and timeouts.
+    QHash<QNetworkReply*, KQOAuthRequestState> authorizedReplies;
+    QHash<KQOAuthRequest*, QNetworkReply*> authorizedRequests;
+
     Q_DECLARE_PUBLIC(KQOAuthManager);
 };
 
@@ -22,6 +22,8 @@
 #include <QCryptographicHash>
 #include <QPair>
 #include <QStringList>
+#include <QHash>
+#include <QVarLengthArray>
 
 #include <QtDebug>
 #include <QtAlgorithms>
@@ -105,8 +107,19 @@ QString KQOAuthRequestPrivate::oauthSignature()  {
      **/
     QByteArray baseString = this->requestBaseString();
 
-    QString secret = QString(QUrl::toPercentEncoding(oauthConsumerSecretKey)) + "&" + QString(QUrl::toPercentEncoding(oauthTokenSecret));
-    QString signature = KQOAuthUtils::hmac_sha1(baseString, secret);
+    // The secrets are the same for practically every request, so keep
+    // the encoded key with its precomputed HMAC pad state around.
+    static QHash<QString, KQOAuthHmacSha1Key> keyCache;
+    QString cacheKey = oauthConsumerSecretKey + QChar(0) + oauthTokenSecret;
+    QHash<QString, KQOAuthHmacSha1Key>::const_iterator it = keyCache.constFind(cacheKey);
+    if (it == keyCache.constEnd()) {
+        QByteArray secret = QUrl::toPercentEncoding(oauthConsumerSecretKey) + "&" + QUrl::toPercentEncoding(oauthTokenSecret);
+        if (keyCache.size() >= 16) {
+            keyCache.clear();
+        }
+        it = keyCache.insert(cacheKey, KQOAuthHmacSha1Key(secret));
+    }
+    QByteArray signature = it.value().sign(baseString).toBase64();
 
     if (debugOutput) {
         qDebug() << "========== KQOAuthRequest has the following signature:";
@@ -115,82 +128,110 @@ QString KQOAuthRequestPrivate::oauthSignature()  {
     return QString( QUrl::toPercentEncoding(signature) );
 }
 
-bool normalizedParameterSort(const QPair<QString, QString> &left, const QPair<QString, QString> &right) {
-    QString keyLeft = left.first;
-    QString valueLeft = left.second;
-    QString keyRight = right.first;
-    QString valueRight = right.second;
+typedef QPair<QString, QString> KQOAuthParameter;
 
-    if(keyLeft == keyRight) {
-        return (valueLeft < valueRight);
+static bool normalizedParameterSort(const KQOAuthParameter *left, const KQOAuthParameter *right) {
+    if(left->first == right->first) {
+        return (left->second < right->second);
     } else {
-        return (keyLeft < keyRight);
+        return (left->first < right->first);
     }
 }
-QByteArray KQOAuthRequestPrivate::requestBaseString() {
-    QByteArray baseString;
 
-    // Every request has these as the commont parameters.
-    baseString.append( oauthHttpMethodString.toUtf8() + "&");                                                     // HTTP method
-    baseString.append( QUrl::toPercentEncoding( oauthRequestEndpoint.toString(QUrl::RemoveQuery) ) + "&" ); // The path and query components
+static inline bool isUnreserved(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+           (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' || c == '~';
+}
 
-    QList< QPair<QString, QString> > baseStringParameters;
-    baseStringParameters.append(requestParameters);
-    baseStringParameters.append(additionalParameters);
+static const char hexDigits[] = "0123456789ABCDEF";
 
-    // Sort the request parameters. These parameters have been
-    // initialized earlier.
-    qSort(baseStringParameters.begin(),
-          baseStringParameters.end(),
-          normalizedParameterSort
-          );
+// Same as QUrl::toPercentEncoding(), appending to buffer.
+static void appendEncoded(QByteArray &buffer, const QByteArray &data) {
+    for (int i = 0; i < data.size(); i++) {
+        unsigned char c = data.at(i);
+        if (isUnreserved(c)) {
+            buffer.append(char(c));
+        } else {
+            buffer.append('%');
+            buffer.append(hexDigits[c >> 4]);
+            buffer.append(hexDigits[c & 0xf]);
+        }
+    }
+}
 
-    // Last append the request parameters correctly encoded.
-    baseString.append( encodedParamaterList(baseStringParameters) );
+// Same as percent encoding data twice: the '%' of every escape
+// becomes "%25".
+static void appendDoubleEncoded(QByteArray &buffer, const QByteArray &data) {
+    for (int i = 0; i < data.size(); i++) {
+        unsigned char c = data.at(i);
+        if (isUnreserved(c)) {
+            buffer.append(char(c));
+        } else {
+            buffer.append("%25", 3);
+            buffer.append(hexDigits[c >> 4]);
+            buffer.append(hexDigits[c & 0xf]);
+        }
+    }
+}
 
-    if (debugOutput) {
-        qDebug() << "========== KQOAuthRequest has the following base string:";
-        qDebug() << baseString << "\n";
+QByteArray KQOAuthRequestPrivate::requestBaseString() {
+    // Sort pointers to the request parameters rather than a copy of
+    // the parameters themselves. These parameters have been
+    // initialized earlier.
+    QVarLengthArray<const KQOAuthParameter *, 16> parameters;
+    int parametersLength = 0;
+    for (int i = 0; i < requestParameters.size(); i++) {
+        parameters.append(&requestParameters.at(i));
+    }
+    for (int i = 0; i < additionalParameters.size(); i++) {
+        parameters.append(&additionalParameters.at(i));
+    }
+    for (int i = 0; i < parameters.size(); i++) {
+        parametersLength += parameters[i]->first.size() + parameters[i]->second.size() + 6;
     }
+    qSort(parameters.data(), parameters.data() + parameters.size(), normalizedParameterSort);
 
-    return baseString;
-}
+    QByteArray endpoint = oauthRequestEndpoint.toString(QUrl::RemoveQuery).toUtf8();
 
-QByteArray KQOAuthRequestPrivate::encodedParamaterList(const QList< QPair<QString, QString> > &parameters) {
-    QByteArray resultList;
+    // Reserve for the worst case of plain ASCII data, every byte
+    // double encoded.
+    QByteArray baseString;
+    baseString.reserve(oauthHttpMethodString.size() + 3*endpoint.size() + 5*parametersLength + 2);
 
-    bool first = true;
-    QPair<QString, QString> parameter;
+    // Every request has these as the commont parameters.
+    baseString.append( oauthHttpMethodString.toUtf8() );  // HTTP method
+    baseString.append( '&' );
+    appendEncoded( baseString, endpoint );                // The path and query components
+    baseString.append( '&' );
 
-    // Do the debug output.
+    // Last append the request parameters correctly encoded, i.e. the
+    // percent encoded "key=value&..." list percent encoded again.
     if (debugOutput) {
         qDebug() << "========== KQOAuthRequest has the following parameters:";
     }
-    foreach (parameter, parameters) {
-        if(!first) {
-            resultList.append( "&" );
-        } else {
-            first = false;
+    for (int i = 0; i < parameters.size(); i++) {
+        if (i > 0) {
+            baseString.append( "%26", 3 );
         }
+        appendDoubleEncoded( baseString, parameters[i]->first.toUtf8() );   // Parameter key
+        baseString.append( "%3D", 3 );
+        appendDoubleEncoded( baseString, parameters[i]->second.toUtf8() );  // Parameter value
 
-        // Here we don't need to explicitely encode the strings to UTF-8 since
-        // QUrl::toPercentEncoding() takes care of that for us.
-        resultList.append( QUrl::toPercentEncoding(parameter.first)     // Parameter key
-                           + "="
-                           + QUrl::toPercentEncoding(parameter.second)  // Parameter value
-                          );
         if (debugOutput) {
             qDebug() << " * "
-                     << parameter.first
+                     << parameters[i]->first
                      << " : "
-                     << parameter.second;
+                     << parameters[i]->second;
         }
     }
+
     if (debugOutput) {
         qDebug() << "\n";
+        qDebug() << "========== KQOAuthRequest has the following base string:";
+        qDebug() << baseString << "\n";
     }
 
-    return QUrl::toPercentEncoding(resultList);
+    return baseString;
 }
 
 QString KQOAuthRequestPrivate::oauthTimestamp() const {
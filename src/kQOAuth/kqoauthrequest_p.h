@@ -45,7 +45,6 @@ public:
     void signRequest();
     bool validateRequest() const;
     QByteArray requestBaseString();
-    QByteArray encodedParamaterList(const QList< QPair<QString, QString> > &requestParameters);
     void insertAdditionalParams();
     void insertPostBody();
 
@@ -18,62 +18,172 @@
  *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <QString>
-#include <QCryptographicHash>
 #include <QByteArray>
 
+#include <string.h>
+
 #include <QtDebug>
 #include "kqoauthutils.h"
 
-QString KQOAuthUtils::hmac_sha1(const QString &message, const QString &key)
+//////////// KQOAuthSha1 ////////////////
+
+static inline quint32 rol(quint32 value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+KQOAuthSha1::KQOAuthSha1()
 {
-    QByteArray keyBytes = key.toLatin1();
-    int keyLength;              // Lenght of key word
-    const int blockSize = 64;   // Both MD5 and SHA-1 have a block size of 64.
-
-    keyLength = keyBytes.size();
-    // If key is longer than block size, we need to hash the key
-    if (keyLength > blockSize) {
-        QCryptographicHash hash(QCryptographicHash::Sha1);
-        hash.addData(keyBytes);
-        keyBytes = hash.result();
+    reset();
+}
+
+void KQOAuthSha1::reset() {
+    h[0] = 0x67452301;
+    h[1] = 0xEFCDAB89;
+    h[2] = 0x98BADCFE;
+    h[3] = 0x10325476;
+    h[4] = 0xC3D2E1F0;
+    length = 0;
+    bufferLength = 0;
+}
+
+void KQOAuthSha1::processBlock(const unsigned char *block) {
+    quint32 w[80];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (quint32(block[4*i]) << 24) | (quint32(block[4*i+1]) << 16) |
+               (quint32(block[4*i+2]) << 8) | quint32(block[4*i+3]);
+    }
+    for (int i = 16; i < 80; i++) {
+        w[i] = rol(w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16], 1);
     }
 
-    /* http://tools.ietf.org/html/rfc2104  - (1) */
-    // Create the opad and ipad for the hash function.
-    QByteArray ipad;
-    QByteArray opad;
+    quint32 a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+        quint32 f, k;
+        if (i < 20) {
+            f = (b & c) | (~b & d);
+            k = 0x5A827999;
+        } else if (i < 40) {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        } else if (i < 60) {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDC;
+        } else {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+        quint32 temp = rol(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = rol(b, 30);
+        b = a;
+        a = temp;
+    }
 
-    ipad.fill( 0, blockSize);
-    opad.fill( 0, blockSize);
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+}
 
-    ipad.replace(0, keyBytes.length(), keyBytes);
-    opad.replace(0, keyBytes.length(), keyBytes);
+void KQOAuthSha1::addData(const char *data, int len) {
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+    length += len;
 
-    /* http://tools.ietf.org/html/rfc2104 - (2) & (5) */
-    for (int i=0; i<64; i++) {
-        ipad[i] = ipad[i] ^ 0x36;
-        opad[i] = opad[i] ^ 0x5c;
+    if (bufferLength > 0) {
+        int n = qMin(64 - bufferLength, len);
+        memcpy(buffer + bufferLength, p, n);
+        bufferLength += n;
+        p += n;
+        len -= n;
+        if (bufferLength < 64) {
+            return;
+        }
+        processBlock(buffer);
+        bufferLength = 0;
     }
 
-    QByteArray workArray;
-    workArray.clear();
+    while (len >= 64) {
+        processBlock(p);
+        p += 64;
+        len -= 64;
+    }
 
-    workArray.append(ipad, 64);
-    /* http://tools.ietf.org/html/rfc2104 - (3) */
-    workArray.append(message.toLatin1());
+    if (len > 0) {
+        memcpy(buffer, p, len);
+        bufferLength = len;
+    }
+}
 
+QByteArray KQOAuthSha1::result() const {
+    KQOAuthSha1 copy(*this);
 
-    /* http://tools.ietf.org/html/rfc2104 - (4) */
-    QByteArray sha1 = QCryptographicHash::hash(workArray, QCryptographicHash::Sha1);
+    unsigned char padding[72];
+    memset(padding, 0, sizeof(padding));
+    padding[0] = 0x80;
+    int padLength = (bufferLength < 56 ? 56 : 120) - bufferLength;
 
-    /* http://tools.ietf.org/html/rfc2104 - (6) */
-    workArray.clear();
-    workArray.append(opad, 64);
-    workArray.append(sha1);
+    quint64 bits = length * 8;
+    for (int i = 0; i < 8; i++) {
+        padding[padLength + i] = (unsigned char)(bits >> (56 - 8*i));
+    }
+    copy.addData(reinterpret_cast<const char *>(padding), padLength + 8);
 
-    sha1.clear();
+    QByteArray digest(20, 0);
+    for (int i = 0; i < 5; i++) {
+        digest[4*i]   = char(copy.h[i] >> 24);
+        digest[4*i+1] = char(copy.h[i] >> 16);
+        digest[4*i+2] = char(copy.h[i] >> 8);
+        digest[4*i+3] = char(copy.h[i]);
+    }
+    return digest;
+}
+
+//////////// KQOAuthHmacSha1Key ////////////////
+
+KQOAuthHmacSha1Key::KQOAuthHmacSha1Key(const QByteArray &key)
+{
+    const int blockSize = 64;
+
+    /* http://tools.ietf.org/html/rfc2104  - (1) */
+    QByteArray keyBytes = key;
+    if (keyBytes.size() > blockSize) {
+        KQOAuthSha1 hash;
+        hash.addData(keyBytes);
+        keyBytes = hash.result();
+    }
+
+    /* http://tools.ietf.org/html/rfc2104 - (2) & (5) */
+    char ipad[blockSize];
+    char opad[blockSize];
+    for (int i = 0; i < blockSize; i++) {
+        char k = i < keyBytes.size() ? keyBytes.at(i) : 0;
+        ipad[i] = k ^ 0x36;
+        opad[i] = k ^ 0x5c;
+    }
+
+    // Hash the pads once here, sign() continues from copies of the state.
+    inner.addData(ipad, blockSize);
+    outer.addData(opad, blockSize);
+}
+
+QByteArray KQOAuthHmacSha1Key::sign(const QByteArray &message) const {
+    /* http://tools.ietf.org/html/rfc2104 - (3) & (4) */
+    KQOAuthSha1 hash(inner);
+    hash.addData(message);
+    QByteArray innerDigest = hash.result();
 
-    /* http://tools.ietf.org/html/rfc2104 - (7) */
-    sha1 = QCryptographicHash::hash(workArray, QCryptographicHash::Sha1);
-    return QString(sha1.toBase64());
+    /* http://tools.ietf.org/html/rfc2104 - (6) & (7) */
+    hash = outer;
+    hash.addData(innerDigest);
+    return hash.result();
+}
+
+//////////// KQOAuthUtils ////////////////
+
+QString KQOAuthUtils::hmac_sha1(const QString &message, const QString &key)
+{
+    KQOAuthHmacSha1Key hmacKey(key.toLatin1());
+    return QString(hmacKey.sign(message.toLatin1()).toBase64());
 }
@@ -22,7 +22,48 @@
 
 #include "kqoauthglobals.h"
 
+#include <QByteArray>
+
 class QString;
+
+// Minimal SHA-1 whose state can be copied. This makes it possible to
+// hash a common prefix once and continue from a copy of the state.
+class KQOAUTH_EXPORT KQOAuthSha1
+{
+public:
+    KQOAuthSha1();
+
+    void reset();
+    void addData(const char *data, int length);
+    void addData(const QByteArray &data) { addData(data.constData(), data.size()); }
+
+    // Returns the 20 byte digest, the state itself is left untouched.
+    QByteArray result() const;
+
+private:
+    void processBlock(const unsigned char *block);
+
+    quint32 h[5];
+    quint64 length;
+    unsigned char buffer[64];
+    int bufferLength;
+};
+
+// HMAC-SHA1 key with the inner and outer pad already hashed, so that
+// signing a message costs only the hashing of the message itself.
+class KQOAUTH_EXPORT KQOAuthHmacSha1Key
+{
+public:
+    explicit KQOAuthHmacSha1Key(const QByteArray &key = QByteArray());
+
+    // Returns the raw 20 byte HMAC of message.
+    QByteArray sign(const QByteArray &message) const;
+
+private:
+    KQOAuthSha1 inner;
+    KQOAuthSha1 outer;
+};
+
 class KQOAUTH_EXPORT KQOAuthUtils
 {
 public:
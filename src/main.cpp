@@ -24,9 +24,16 @@
 
 #include "pumpapp.h"
 #include "util.h"
+#include "trafficrecorder.h"
+#include "stallwatchdog.h"
+#include "tracelog.h"
+#include "kqoauthutils.h"
+#include "kqoauthrequest_p.h"
+#include "oauthexample.h"
 
 #include <QTranslator>
 #include <QLocale>
+#include <QCryptographicHash>
 
 //------------------------------------------------------------------------------
 
@@ -41,6 +48,94 @@ int testMarkup(QString str) {
 
 //------------------------------------------------------------------------------
 
+static qint64 qtParseTime(QString str) {
+  QDateTime dt = QDateTime::fromString(str, Qt::ISODate);
+  dt.setTimeSpec(Qt::UTC);
+  return dt.toMSecsSinceEpoch();
+}
+
+//------------------------------------------------------------------------------
+
+int autoTestParseTime() {
+  const char* valid[] = { "2013-05-28T16:43:06Z", "1970-01-01T00:00:00Z",
+                          "2000-02-29T23:59:59Z", "2012-12-31T12:00:00Z",
+                          "1969-07-20T20:17:40Z", "2100-03-01T00:00:00Z",
+                          0 };
+  for (int i=0; valid[i]; i++) {
+    bool ok = false;
+    qint64 t = parseIsoTime(valid[i], &ok);
+    (void) t;
+    Q_ASSERT(ok && t == qtParseTime(valid[i]));
+  }
+
+  bool ok = false;
+  Q_ASSERT(parseIsoTime("1970-01-01T00:00:00.5Z", &ok) == 500 && ok);
+  Q_ASSERT(parseIsoTime("1970-01-01T00:00:01.123Z", &ok) == 1123 && ok);
+  Q_ASSERT(parseIsoTime("1970-01-01T00:00:01.123456Z", &ok) == 1123 && ok);
+
+  const char* invalid[] = { "", "foo", "2013-02-29T00:00:00Z",
+                            "2013-13-01T00:00:00Z", "2013-05-28T24:00:00Z",
+                            "2013-05-28T16:43:06.Z", 0 };
+  for (int i=0; invalid[i]; i++) {
+    parseIsoTime(invalid[i], &ok);
+    Q_ASSERT(!ok);
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int autoTestOAuth() {
+  // HMAC-SHA1 test cases from RFC 2202
+  struct { QByteArray key, data; const char* digest; } hmac[] = {
+    { QByteArray(20, 0x0b), "Hi There",
+      "b617318655057264e28bc0b6fb378c8ef146be00" },
+    { "Jefe", "what do ya want for nothing?",
+      "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79" },
+    { QByteArray(20, 0xaa), QByteArray(50, 0xdd),
+      "125d7342b9ac11cd91a39af48aa17b4f63f175d3" },
+    { QByteArray(80, 0xaa),
+      "Test Using Larger Than Block-Size Key - Hash Key First",
+      "aa4ae5e15272d00e95705637ce8a3b55ed402112" },
+    { QByteArray(80, 0xaa), "Test Using Larger Than Block-Size Key and "
+      "Larger Than One Block-Size Data",
+      "e8e99d0f45237d786d6bbaa7965c7808bbff1a91" }
+  };
+  for (size_t i=0; i<sizeof(hmac)/sizeof(hmac[0]); i++) {
+    KQOAuthHmacSha1Key key(hmac[i].key);
+    Q_ASSERT(key.sign(hmac[i].data).toHex() == hmac[i].digest);
+    Q_ASSERT(key.sign(hmac[i].data).toHex() == hmac[i].digest);
+  }
+
+  QByteArray data;
+  for (int i=0; i<300; i++) {
+    KQOAuthSha1 sha1;
+    sha1.addData(data.left(i/2));
+    sha1.addData(data.mid(i/2));
+    Q_ASSERT(sha1.result() ==
+             QCryptographicHash::hash(data, QCryptographicHash::Sha1));
+    data.append(char(i*7));
+  }
+
+  KQOAuthRequestPrivate d;
+  initOAuthExample(d);
+  Q_ASSERT(d.requestBaseString() ==
+           "GET&http%3A%2F%2Fphotos.example.net%2Fphotos&file%3Dvacation.jpg"
+           "%26oauth_consumer_key%3Ddpf43f3p2l4k3l03%26oauth_nonce%3Dkllo9940"
+           "pd9333jh%26oauth_signature_method%3DHMAC-SHA1%26oauth_timestamp"
+           "%3D1191242096%26oauth_token%3Dnnch734d00sl2jdk%26oauth_version"
+           "%3D1.0%26size%3Doriginal");
+  Q_ASSERT(d.oauthSignature() == "tR3%2BTy81lMeYAr%2FFid0kMTYa%2FWM%3D");
+
+  d.additionalParameters << qMakePair(QString("q"),
+                                      QString::fromUtf8("a b&c=\xc3\xa4"));
+  Q_ASSERT(d.requestBaseString().endsWith(
+             "%26q%3Da%2520b%2526c%253D%25C3%25A4%26size%3Doriginal"));
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+
 int main(int argc, char** argv) {
   QApplication app(argc, argv);
   QString locale = QLocale::system().name();
@@ -86,13 +181,32 @@ int main(int argc, char** argv) {
       Q_ASSERT(f(255) == 0);
       return 0;
     }
-    else if (arg == "-l" && argc == 3) {
-      locale = argv[2];
-    } else if (arg == "-c" && argc == 3) {
-      settingsFile = argv[2];
+    else if (arg == "autotestparsetime") {
+      return autoTestParseTime();
+    }
+    else if (arg == "autotestoauth") {
+      return autoTestOAuth();
+    }
+  }
+
+  for (int i=1; i<argc; i++) {
+    QString arg(argv[i]);
+    if (arg == "-l" && i+1 < argc) {
+      locale = argv[++i];
+    } else if (arg == "-c" && i+1 < argc) {
+      settingsFile = argv[++i];
+    } else if (arg == "-r" && i+1 < argc) {
+      if (!TrafficRecorder::start(argv[++i]))
+        return 1;
+    } else if (arg == "-w" && i+1 < argc && atoi(argv[i+1]) > 0) {
+      StallWatchdog::start(atoi(argv[++i]));
+    } else if (arg == "-t" && i+1 < argc) {
+      if (!TraceLog::start(argv[++i]))
+        return 1;
     }
     else {
-      qDebug() << "Usage: ./pumpa [-c alternative.conf] [-l locale]";
+      qDebug() << "Usage: ./pumpa [-c alternative.conf] [-l locale] "
+        "[-r record_dir] [-w stall_msecs] [-t trace.json]";
       return 0;
     }
   }
@@ -106,5 +220,8 @@ int main(int argc, char** argv) {
     qDebug() << "Successfully loaded translation";
 
   PumpApp papp(settingsFile);
-  return app.exec();
+  int ret = app.exec();
+  TrafficRecorder::stop();
+  TraceLog::stop();
+  return ret;
 }
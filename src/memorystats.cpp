@@ -0,0 +1,144 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "memorystats.h"
+#include "qactivitystreams.h"
+#include "filedownloader.h"
+#include "perfstats.h"
+#include "aswidget.h"
+#include "util.h"
+
+#include <QStringList>
+#include <QLabel>
+#include <QPixmap>
+#include <QSet>
+
+//------------------------------------------------------------------------------
+
+static QString row(QString name, qint64 count, qint64 bytes) {
+  return QString("  %1 %2 %3").arg(name, -24).arg(count, 8)
+    .arg(MemoryStats::formatBytes(bytes), 12);
+}
+
+//------------------------------------------------------------------------------
+
+QString MemoryStats::formatBytes(qint64 bytes) {
+  if (bytes < 1024)
+    return QString("%1 B").arg(bytes);
+  if (bytes < 1024*1024)
+    return QString("%1 KB").arg(bytes/1024.0, 0, 'f', 1);
+  return QString("%1 MB").arg(bytes/(1024.0*1024.0), 0, 'f', 1);
+}
+
+//------------------------------------------------------------------------------
+
+QString MemoryStats::report(const QTabWidget* tabs) {
+  QStringList lines;
+  QString header = QString("  %1 %2 %3").arg("", -24).arg("count", 8)
+    .arg("bytes", 12);
+
+  lines << "Cached objects" << header;
+  qint64 total = QASObject::cacheBytes() + QASActivity::cacheBytes() +
+    QASCollection::cacheBytes() + QASObjectList::cacheBytes() +
+    QASObjectList::recipientListBytes() + QASActorList::cacheBytes();
+  lines << row("objects and persons", QASObject::cacheItems(),
+               QASObject::cacheBytes());
+  lines << row("activities", QASActivity::cacheItems(),
+               QASActivity::cacheBytes());
+  lines << row("collections", QASCollection::cacheItems(),
+               QASCollection::cacheBytes());
+  lines << row("object lists", QASObjectList::cacheItems(),
+               QASObjectList::cacheBytes());
+  lines << row("recipient lists", QASObjectList::recipientListCount(),
+               QASObjectList::recipientListBytes());
+  lines << row("person lists", QASActorList::cacheItems(),
+               QASActorList::cacheBytes());
+  lines << QString("  %1 %2").arg("total", -33).arg(formatBytes(total), 12);
+  lines << "";
+
+  if (tabs) {
+    // Avatars are shared between many labels, so pixmaps are counted
+    // once per cache key, in the first tab they show up in.
+    QSet<qint64> seenPixmaps;
+
+    lines << "Widgets" << QString("  %1 %2 %3 %4 %5").arg("tab", -16)
+      .arg("items", 6).arg("widgets", 8).arg("text", 10).arg("pixmaps", 14);
+    for (int i=0; i<tabs->count(); i++) {
+      QWidget* page = tabs->widget(i);
+      QList<QWidget*> children = page->findChildren<QWidget*>();
+
+      qint64 textBytes = 0, pixmapBytes = 0;
+      int pixmaps = 0;
+      for (int j=0; j<children.count(); j++) {
+        QLabel* label = qobject_cast<QLabel*>(children[j]);
+        if (!label)
+          continue;
+        textBytes += stringBytes(label->text());
+
+        const QPixmap* pix = label->pixmap();
+        if (!pix || pix->isNull() || seenPixmaps.contains(pix->cacheKey()))
+          continue;
+        seenPixmaps.insert(pix->cacheKey());
+        pixmaps++;
+        pixmapBytes += qint64(pix->width()) * pix->height() * pix->depth() / 8;
+      }
+
+      ASWidget* asw = qobject_cast<ASWidget*>(page);
+      lines << QString("  %1 %2 %3 %4 %5").
+        arg(tabs->tabText(i).remove('&'), -16).
+        arg(asw ? QString::number(asw->count()) : QString("-"), 6).
+        arg(children.count()+1, 8).arg(formatBytes(textBytes), 10).
+        arg(QString("%1 / %2").arg(pixmaps).arg(formatBytes(pixmapBytes)),
+            14);
+    }
+    lines << "";
+  }
+
+  qint64 bytes = 0;
+  int files = FileDownloader::diskCacheUsage(&bytes);
+  lines << "Disk cache " + FileDownloader::getCacheDir() << header;
+  lines << row("files", files, bytes);
+  files = FileDownloader::duplicateCount(&bytes);
+  lines << row("duplicates linked", files, bytes);
+  lines << QString("  %1 %2").arg("proxy URL aliases", -24)
+    .arg(imageUrlAliasCount(), 8);
+  lines << "";
+
+  int replies = RequestTimer::pendingReplies(&bytes);
+  lines << "Network" << header;
+  lines << row("replies in flight", replies, bytes);
+  lines << QString("  %1 %2").arg("image downloads", -24)
+    .arg(FileDownloader::downloadingCount(), 8);
+  lines << QString("  %1 %2").arg("queued downloads", -24)
+    .arg(FileDownloader::queuedCount(), 8);
+  lines << QString("  %1 %2").arg("cancelled downloads", -24)
+    .arg(FileDownloader::cancelledCount(), 8);
+  lines << "";
+
+  long rss = getCurrentRSS();
+  lines << "Process";
+  if (rss > 0) {
+    lines << QString("  resident %1, peak %2").arg(formatBytes(rss))
+      .arg(formatBytes(qint64(getMaxRSS())*1024));
+  } else {
+    lines << "  resident set size only available when built with DEBUG_MEMORY";
+  }
+
+  return lines.join("\n");
+}
@@ -0,0 +1,43 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _MEMORYSTATS_H_
+#define _MEMORYSTATS_H_
+
+#include <QString>
+#include <QTabWidget>
+
+//------------------------------------------------------------------------------
+
+/*
+  Accounts for where memory goes: the cached activity streams
+  objects, the widgets and decoded images in each tab, the disk cache
+  and data still in flight on the network. Byte counts are estimates
+  from the sizes of the objects and their strings, not measurements
+  of the heap.
+*/
+class MemoryStats {
+public:
+  // Human readable report, tabs can be NULL to skip the widgets.
+  static QString report(const QTabWidget* tabs);
+
+  static QString formatBytes(qint64 bytes);
+};
+
+#endif /* _MEMORYSTATS_H_ */
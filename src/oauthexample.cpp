@@ -0,0 +1,42 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "oauthexample.h"
+#include "kqoauthrequest_p.h"
+
+//------------------------------------------------------------------------------
+
+void initOAuthExample(KQOAuthRequestPrivate& d) {
+  d.debugOutput = false;
+  d.oauthHttpMethodString = "GET";
+  d.oauthRequestEndpoint = QUrl("http://photos.example.net/photos");
+  d.oauthConsumerSecretKey = "kd94hf93k423kf44";
+  d.oauthTokenSecret = "pfkkdhi9sl3r4s00";
+  d.requestParameters
+    << qMakePair(QString("oauth_consumer_key"), QString("dpf43f3p2l4k3l03"))
+    << qMakePair(QString("oauth_token"), QString("nnch734d00sl2jdk"))
+    << qMakePair(QString("oauth_signature_method"), QString("HMAC-SHA1"))
+    << qMakePair(QString("oauth_timestamp"), QString("1191242096"))
+    << qMakePair(QString("oauth_nonce"), QString("kllo9940pd9333jh"))
+    << qMakePair(QString("oauth_version"), QString("1.0"));
+  d.additionalParameters
+    << qMakePair(QString("size"), QString("original"))
+    << qMakePair(QString("file"), QString("vacation.jpg"));
+}
@@ -0,0 +1,33 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef _OAUTHEXAMPLE_H_
+#define _OAUTHEXAMPLE_H_
+
+class KQOAuthRequestPrivate;
+
+//------------------------------------------------------------------------------
+
+// Fills in the request from Appendix A of the OAuth Core 1.0
+// specification, whose base string and signature are known. Shared by
+// the autotestoauth mode and the micro-benchmarks.
+void initOAuthExample(KQOAuthRequestPrivate& d);
+
+#endif /* _OAUTHEXAMPLE_H_ */
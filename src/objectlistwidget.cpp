@@ -41,7 +41,8 @@ QASAbstractObjectList* ObjectListWidget::initList(QString endpoint,
 
 void ObjectListWidget::update() {
   ASWidget::update();
-  fetchOlder();
+  if (!updatePending())
+    fetchOlder();
 }
 
 //------------------------------------------------------------------------------
@@ -99,7 +99,7 @@ void ObjectWidget::changeObject(QASAbstractObject* obj, bool fullObject) {
 
   m_contextLabel->setVisible(false);
   m_contextButton->setVisible(false);
-  if (m_object->type() == "comment" && m_object->inReplyTo()) {
+  if (m_object->typeId() == QASObject::CommentType && m_object->inReplyTo()) {
     m_irtObject = m_object->inReplyTo();
     connect(m_irtObject, SIGNAL(changed()), this, SLOT(updateContextLabel()));
 
@@ -18,13 +18,74 @@
 */
 
 #include "objectwidgetwithsignals.h"
+#include "aswidget.h"
+#include "actorwidget.h"
 
 #include <QDebug>
 
 //------------------------------------------------------------------------------
 
 ObjectWidgetWithSignals::ObjectWidgetWithSignals(QWidget* parent) :
-  QFrame(parent) {}
+  QFrame(parent),
+  m_imagesWanted(false)
+{}
+
+//------------------------------------------------------------------------------
+
+void ObjectWidgetWithSignals::cacheHeightForWidth(int w, int h) {
+  // A few widths are enough for resizing back and forth, anything
+  // more is a window being dragged wider or narrower.
+  if (m_heightCache.count() >= 8)
+    m_heightCache.clear();
+  m_heightCache.insert(w, h);
+}
+
+//------------------------------------------------------------------------------
+
+void ObjectWidgetWithSignals::setImagesWanted(bool wanted) {
+  if (wanted == m_imagesWanted)
+    return;
+  m_imagesWanted = wanted;
+
+  QList<ActorWidget*> actors = findChildren<ActorWidget*>();
+  for (int i=0; i<actors.count(); i++)
+    actors[i]->updateDownload();
+
+  updateImages();
+  QList<ObjectWidgetWithSignals*> children =
+    findChildren<ObjectWidgetWithSignals*>();
+  for (int i=0; i<children.count(); i++)
+    children[i]->updateImages();
+}
+
+//------------------------------------------------------------------------------
+
+// It's the outermost object widget inside a timeline, i.e. the row,
+// that decides.
+bool ObjectWidgetWithSignals::imagesWanted(const QWidget* w) {
+  const ObjectWidgetWithSignals* row = NULL;
+  for (; w; w = w->parentWidget()) {
+    if (qobject_cast<const ASWidget*>(w))
+      return row ? row->m_imagesWanted : true;
+
+    const ObjectWidgetWithSignals* ow =
+      qobject_cast<const ObjectWidgetWithSignals*>(w);
+    if (ow)
+      row = ow;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+bool ObjectWidgetWithSignals::event(QEvent* e) {
+  // Any change of the contents, text, images, buttons shown or
+  // hidden, ends up as a layout request on the widget before its
+  // size hints change.
+  if (e->type() == QEvent::LayoutRequest)
+    clearHeightCache();
+  return QFrame::event(e);
+}
 
 //------------------------------------------------------------------------------
 
@@ -21,6 +21,7 @@
 #define _OBJECTWIDGETWITHSIGNALS_H_
 
 #include <QFrame>
+#include <QHash>
 #include "qactivitystreams.h"
 
 //------------------------------------------------------------------------------
@@ -39,6 +40,23 @@ public:
   static void disconnectSignals(ObjectWidgetWithSignals* ow, QWidget* w);
 
   virtual void refreshTimeLabels() = 0;
+
+  // Height of the widget for a given width as last computed by the
+  // timeline layout, or -1 if not known. Forgotten whenever the
+  // contents need a new layout.
+  int cachedHeightForWidth(int w) const { return m_heightCache.value(w, -1); }
+  void cacheHeightForWidth(int w, int h);
+  void clearHeightCache() { m_heightCache.clear(); }
+
+  // Set by the timeline on its rows, depending on how close to the
+  // visible area they are. Images are only downloaded for widgets in
+  // rows that want them, or outside of timelines.
+  void setImagesWanted(bool wanted);
+  static bool imagesWanted(const QWidget* w);
+
+  // Starts or cancels the downloads of the widget's own images after
+  // imagesWanted() has changed.
+  virtual void updateImages() {}
   
 signals:
   void linkHovered(const QString&);
@@ -50,7 +68,13 @@ signals:
   void request(QString, int);
 
 protected:
+  virtual bool event(QEvent* e);
+
   void refreshObject(QASAbstractObject* obj);
+
+private:
+  QHash<int, int> m_heightCache;
+  bool m_imagesWanted;
 };
 
 #endif /* _OBJECTWIDGETWITHSIGNALS_H_ */
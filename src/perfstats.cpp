@@ -0,0 +1,291 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "perfstats.h"
+
+#include <QStringList>
+#include <string.h>
+
+//------------------------------------------------------------------------------
+
+PerfStats::Histogram PerfStats::s_hist[NumClasses][NumPhases];
+qint64 PerfStats::s_widgetNsecs = 0;
+int PerfStats::s_pendingUpdates = 0;
+int WidgetTimer::s_depth = 0;
+QSet<RequestTimer*> RequestTimer::s_timers;
+QList<RequestTimer*> RequestTimer::s_waiting;
+
+//------------------------------------------------------------------------------
+
+void PerfStats::add(int endpointClass, int phase, qint64 msecs) {
+  if (endpointClass < 0 || endpointClass >= NumClasses ||
+      phase < 0 || phase >= NumPhases || msecs < 0)
+    return;
+
+  int b = 0;
+  while (b < NumBuckets-1 && msecs >= (Q_INT64_C(1) << b))
+    b++;
+
+  Histogram& h = s_hist[endpointClass][phase];
+  h.buckets[b]++;
+  h.count++;
+  h.sum += msecs;
+  if (msecs > h.max)
+    h.max = msecs;
+}
+
+//------------------------------------------------------------------------------
+
+void PerfStats::clear() {
+  memset(s_hist, 0, sizeof(s_hist));
+}
+
+//------------------------------------------------------------------------------
+
+QString PerfStats::className(int endpointClass) {
+  switch (endpointClass) {
+  case Inbox:         return "inbox";
+  case Firehose:      return "firehose";
+  case ObjectRefresh: return "object";
+  case Avatar:        return "avatar";
+  default:            return "other";
+  }
+}
+
+//------------------------------------------------------------------------------
+
+QString PerfStats::phaseName(int phase) {
+  switch (phase) {
+  case Queued:    return "queued";
+  case Tls:       return "tls";
+  case FirstByte: return "ttfb";
+  case Download:  return "download";
+  case Parse:     return "parse";
+  case Model:     return "model";
+  case Widgets:   return "widgets";
+  case Total:     return "total";
+  default:        return "?";
+  }
+}
+
+//------------------------------------------------------------------------------
+
+// Upper bound of the bucket containing the p:th fraction of samples.
+qint64 PerfStats::percentile(const Histogram& h, double p) {
+  qint64 n = qint64(h.count * p + 0.5);
+  qint64 seen = 0;
+  for (int b=0; b<NumBuckets; b++) {
+    seen += h.buckets[b];
+    if (seen >= n && seen > 0)
+      return qMin(Q_INT64_C(1) << b, h.max);
+  }
+  return h.max;
+}
+
+//------------------------------------------------------------------------------
+
+QString PerfStats::report() {
+  QStringList lines;
+
+  for (int c=0; c<NumClasses; c++) {
+    if (s_hist[c][Total].count == 0)
+      continue;
+
+    lines << QString("%1 (%2 requests)").arg(className(c))
+      .arg(s_hist[c][Total].count);
+    lines << QString("  %1 %2 %3 %4 %5 %6").arg("phase", -10)
+      .arg("n", 6).arg("mean", 8).arg("p50", 8).arg("p90", 8).arg("max", 8);
+
+    for (int p=0; p<NumPhases; p++) {
+      const Histogram& h = s_hist[c][p];
+      if (h.count == 0)
+        continue;
+      lines << QString("  %1 %2 %3 %4 %5 %6").arg(phaseName(p), -10)
+        .arg(h.count, 6).arg(double(h.sum)/h.count, 8, 'f', 1)
+        .arg(percentile(h, 0.5), 8).arg(percentile(h, 0.9), 8)
+        .arg(h.max, 8);
+    }
+
+    const Histogram& t = s_hist[c][Total];
+    lines << "  total time histogram (ms):";
+    for (int b=0; b<NumBuckets; b++) {
+      if (t.buckets[b] == 0)
+        continue;
+      QString range = b == 0 ? QString("< 1") :
+        QString("%1-%2").arg(Q_INT64_C(1) << (b-1)).arg(Q_INT64_C(1) << b);
+      if (b == NumBuckets-1)
+        range = QString(">= %1").arg(Q_INT64_C(1) << (b-1));
+      lines << QString("    %1 %2").arg(range, 14).arg(t.buckets[b]);
+    }
+    lines << "";
+  }
+
+  if (lines.isEmpty())
+    lines << "No requests timed yet.";
+
+  return lines.join("\n");
+}
+
+//------------------------------------------------------------------------------
+
+RequestTimer::RequestTimer(int endpointClass, QObject* parent) :
+  QObject(parent),
+  m_last(0),
+  m_widgetNsecs(0),
+  m_class(endpointClass),
+  m_gotHeaders(false),
+  m_replyFinished(false)
+{
+  for (int i=0; i<PerfStats::NumPhases; i++)
+    m_phases[i] = -1;
+  m_timer.start();
+  s_timers.insert(this);
+}
+
+//------------------------------------------------------------------------------
+
+RequestTimer::~RequestTimer() {
+  s_timers.remove(this);
+  s_waiting.removeAll(this);
+}
+
+//------------------------------------------------------------------------------
+
+int RequestTimer::pendingReplies(qint64* bufferedBytes) {
+  int count = 0;
+  qint64 bytes = 0;
+  foreach (RequestTimer* t, s_timers) {
+    if (t->m_replyFinished || !t->m_reply)
+      continue;
+    count++;
+    bytes += t->m_reply->bytesAvailable();
+  }
+  if (bufferedBytes)
+    *bufferedBytes = bytes;
+  return count;
+}
+
+//------------------------------------------------------------------------------
+
+void RequestTimer::setReply(QNetworkReply* reply) {
+  mark(PerfStats::Queued);
+  if (!reply)
+    return;
+  m_reply = reply;
+
+#if QT_VERSION >= 0x050100
+  connect(reply, SIGNAL(encrypted()), this, SLOT(onEncrypted()));
+#endif
+  connect(reply, SIGNAL(metaDataChanged()), this, SLOT(onMetaDataChanged()));
+  connect(reply, SIGNAL(finished()), this, SLOT(onFinished()));
+}
+
+//------------------------------------------------------------------------------
+
+void RequestTimer::mark(int phase) {
+  qint64 now = m_timer.elapsed();
+  m_phases[phase] = qMax(m_phases[phase], Q_INT64_C(0)) + now - m_last;
+  m_last = now;
+}
+
+//------------------------------------------------------------------------------
+
+void RequestTimer::beginModel() {
+  m_widgetNsecs = PerfStats::widgetNsecs();
+}
+
+//------------------------------------------------------------------------------
+
+void RequestTimer::endModel() {
+  mark(PerfStats::Model);
+  qint64 widgets = (PerfStats::widgetNsecs() - m_widgetNsecs) / 1000000;
+  widgets = qMin(widgets, m_phases[PerfStats::Model]);
+  m_phases[PerfStats::Model] -= widgets;
+  m_phases[PerfStats::Widgets] = widgets;
+}
+
+//------------------------------------------------------------------------------
+
+void RequestTimer::onEncrypted() {
+  if (!m_gotHeaders)
+    mark(PerfStats::Tls);
+}
+
+//------------------------------------------------------------------------------
+
+void RequestTimer::onMetaDataChanged() {
+  if (m_gotHeaders)
+    return;
+  m_gotHeaders = true;
+  mark(PerfStats::FirstByte);
+}
+
+//------------------------------------------------------------------------------
+
+void RequestTimer::onFinished() {
+  replyFinished();
+}
+
+//------------------------------------------------------------------------------
+
+void RequestTimer::replyFinished() {
+  if (m_replyFinished)
+    return;
+  m_replyFinished = true;
+  mark(m_gotHeaders ? PerfStats::Download : PerfStats::FirstByte);
+}
+
+//------------------------------------------------------------------------------
+
+void RequestTimer::finish() {
+  replyFinished();
+  m_phases[PerfStats::Total] = m_timer.elapsed();
+  for (int i=0; i<PerfStats::NumPhases; i++)
+    if (m_phases[i] >= 0)
+      PerfStats::add(m_class, i, m_phases[i]);
+
+  deleteLater();
+}
+
+//------------------------------------------------------------------------------
+
+void RequestTimer::finishAfterWidgets() {
+  if (PerfStats::pendingUpdates() == 0) {
+    finish();
+    return;
+  }
+  m_widgetNsecs = PerfStats::widgetNsecs();
+  s_waiting.append(this);
+}
+
+//------------------------------------------------------------------------------
+
+void RequestTimer::widgetsDone() {
+  if (PerfStats::pendingUpdates() > 0 || s_waiting.isEmpty())
+    return;
+
+  QList<RequestTimer*> waiting = s_waiting;
+  s_waiting.clear();
+  foreach (RequestTimer* t, waiting) {
+    qint64 widgets = (PerfStats::widgetNsecs() - t->m_widgetNsecs) / 1000000;
+    t->m_phases[PerfStats::Widgets] =
+      qMax(t->m_phases[PerfStats::Widgets], Q_INT64_C(0)) + widgets;
+    t->finish();
+  }
+}
@@ -0,0 +1,173 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _PERFSTATS_H_
+#define _PERFSTATS_H_
+
+#include <QObject>
+#include <QString>
+#include <QElapsedTimer>
+#include <QNetworkReply>
+#include <QPointer>
+#include <QSet>
+#include <QList>
+
+//------------------------------------------------------------------------------
+
+/*
+  Collects timings of network requests into log2 histograms, one for
+  each endpoint class and request phase.
+*/
+class PerfStats {
+public:
+  enum EndpointClass { Inbox = 0, Firehose, ObjectRefresh, Avatar, Other,
+                       NumClasses };
+
+  enum Phase { Queued = 0, // from request() until handed to the network
+               Tls,        // TLS handshake, where Qt tells us about it
+               FirstByte,  // until response headers arrive
+               Download,   // rest of the response body
+               Parse,      // parseJson() on a worker, with queueing
+               Model,      // model update, excluding widgets
+               Widgets,    // ASWidget::update() calls, until the last slice
+               Total,
+               NumPhases };
+
+  // log2 buckets of milliseconds, the last one is open ended
+  static const int NumBuckets = 18;
+
+  static void add(int endpointClass, int phase, qint64 msecs);
+  static void clear();
+
+  // Total time spent in ASWidget::update() so far, in nanoseconds.
+  static qint64 widgetNsecs() { return s_widgetNsecs; }
+  static void addWidgetNsecs(qint64 ns) { s_widgetNsecs += ns; }
+
+  // Number of ASWidgets with update() slices still to run.
+  static int pendingUpdates() { return s_pendingUpdates; }
+  static void setUpdatePending(bool pending) {
+    s_pendingUpdates += pending ? 1 : -1;
+  }
+
+  static QString className(int endpointClass);
+  static QString phaseName(int phase);
+
+  // Human readable summary of all histograms.
+  static QString report();
+
+private:
+  struct Histogram {
+    qint64 buckets[NumBuckets];
+    qint64 count;
+    qint64 sum;
+    qint64 max;
+  };
+
+  static qint64 percentile(const Histogram& h, double p);
+
+  static Histogram s_hist[NumClasses][NumPhases];
+  static qint64 s_widgetNsecs;
+  static int s_pendingUpdates;
+};
+
+//------------------------------------------------------------------------------
+
+/*
+  Times one request through its phases. The network phases are
+  picked up from the reply's signals, the rest are marked by the
+  caller. finish() adds everything to PerfStats and deletes the
+  timer.
+*/
+class RequestTimer : public QObject {
+  Q_OBJECT
+
+public:
+  RequestTimer(int endpointClass, QObject* parent=0);
+  ~RequestTimer();
+
+  void setReply(QNetworkReply* reply);
+
+  // Ends the download phase, if the reply's finished() signal hasn't
+  // already done so.
+  void replyFinished();
+
+  // Attributes time since the previous mark to phase.
+  void mark(int phase);
+
+  // Marks the end of the model update, moving the time spent in
+  // widgets since beginModel() to the Widgets phase.
+  void beginModel();
+  void endModel();
+
+  void finish();
+
+  // Like finish(), but if widget creation continues in later event
+  // loop iterations, waits until it is done and adds that time to the
+  // Widgets phase.
+  void finishAfterWidgets();
+
+  // Finishes the waiting timers if no updates are pending any more.
+  // Called when the outermost WidgetTimer ends.
+  static void widgetsDone();
+
+  // Milliseconds since the timer was created.
+  qint64 elapsed() const { return m_timer.elapsed(); }
+
+  // Number of replies still downloading and the bytes they have
+  // buffered so far.
+  static int pendingReplies(qint64* bufferedBytes);
+
+private slots:
+  void onEncrypted();
+  void onMetaDataChanged();
+  void onFinished();
+
+private:
+  QElapsedTimer m_timer;
+  qint64 m_last;
+  qint64 m_widgetNsecs;
+  int m_class;
+  qint64 m_phases[PerfStats::NumPhases];
+  bool m_gotHeaders;
+  bool m_replyFinished;
+  QPointer<QNetworkReply> m_reply;
+
+  static QSet<RequestTimer*> s_timers;
+  static QList<RequestTimer*> s_waiting;
+};
+
+//------------------------------------------------------------------------------
+
+// Adds the lifetime of the outermost instance to the widget time.
+class WidgetTimer {
+public:
+  WidgetTimer() { if (s_depth++ == 0) m_timer.start(); }
+  ~WidgetTimer() {
+    if (--s_depth == 0) {
+      PerfStats::addWidgetNsecs(m_timer.nsecsElapsed());
+      RequestTimer::widgetsDone();
+    }
+  }
+
+private:
+  QElapsedTimer m_timer;
+  static int s_depth;
+};
+
+#endif /* _PERFSTATS_H_ */
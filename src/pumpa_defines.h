@@ -75,6 +75,17 @@
 
 #define MAX_WORD_LENGTH       40
 
+// Replies are shown this many at a time
+#define REPLIES_PAGE_SIZE     10
+
+// Image downloads running at the same time, the rest wait in a queue
+#define MAX_DOWNLOADS         4
+
+// Failed downloads are retried this many times, waiting 1, 2, 4 ...
+// times DOWNLOAD_RETRY_MSECS in between
+#define DOWNLOAD_RETRIES      3
+#define DOWNLOAD_RETRY_MSECS  1000
+
 //------------------------------------------------------------------------------
 
 #endif /* _PUMPA_DEFINES_H_ */
@@ -28,12 +28,15 @@
 #include "json.h"
 #include "util.h"
 #include "filedownloader.h"
+#include "trafficrecorder.h"
+#include "tracelog.h"
 
 //------------------------------------------------------------------------------
 
 PumpApp::PumpApp(QString settingsFile, QWidget* parent) : 
   QMainWindow(parent),
   m_nextRequestId(0),
+  m_diagnosticsDialog(NULL),
   m_contextWidget(NULL),
   m_wiz(NULL),
   m_messageWindow(NULL),
@@ -64,8 +67,16 @@ PumpApp::PumpApp(QString settingsFile, QWidget* parent) :
   m_nam = new QNetworkAccessManager(this);
 
   oaManager = new KQOAuthManager(this);
-  connect(oaManager, SIGNAL(authorizedRequestReady(QByteArray, int)),
-          this, SLOT(onAuthorizedRequestReady(QByteArray, int)));
+  connect(oaManager,
+          SIGNAL(authorizedRequestFinished(QByteArray, int,
+                                           KQOAuthManager::KQOAuthError)),
+          this,
+          SLOT(onAuthorizedRequestReady(QByteArray, int,
+                                        KQOAuthManager::KQOAuthError)));
+
+  m_responseWorker = new ResponseWorker(this);
+  connect(m_responseWorker, SIGNAL(parsed(const ParsedResponse&)),
+          this, SLOT(onResponseParsed(const ParsedResponse&)));
 
   createActions();
   createMenu();
@@ -88,6 +99,8 @@ PumpApp::PumpApp(QString settingsFile, QWidget* parent) :
 
   int max_tl = m_s->maxTimelineItems();
   int max_fh = m_s->maxFirehoseItems();
+  ASWidget::setImagePrefetch(m_s->imagePrefetchPages());
+  FileDownloader::setDeduplicate(m_s->dedupeImageCache());
 
   m_inboxWidget = new CollectionWidget(this, max_tl);
   connectCollection(m_inboxWidget);
@@ -276,6 +289,19 @@ void PumpApp::debugAction() {
   qDebug() << "inbox" << m_inboxWidget->count();
   qDebug() << "meanwhile" << m_inboxMinorWidget->count();
   qDebug() << "firehose" << m_firehoseWidget->count();
+  qDebug() << "recipient lists" << QASObjectList::recipientListCount();
+  qDebug() << "response memo hits" << QASAbstractObject::memoHits()
+           << "of" << QASAbstractObject::memoLookups();
+}
+
+//------------------------------------------------------------------------------
+
+void PumpApp::diagnostics() {
+  if (!m_diagnosticsDialog)
+    m_diagnosticsDialog = new DiagnosticsDialog(m_tabWidget, this);
+  m_diagnosticsDialog->show();
+  m_diagnosticsDialog->raise();
+  m_diagnosticsDialog->activateWindow();
 }
 
 //------------------------------------------------------------------------------
@@ -465,6 +491,9 @@ void PumpApp::createActions() {
   aboutQtAction = new QAction(tr("About &Qt"), this);
   connect(aboutQtAction, SIGNAL(triggered()), qApp, SLOT(aboutQt()));
 
+  diagnosticsAction = new QAction(tr("&Diagnostics"), this);
+  connect(diagnosticsAction, SIGNAL(triggered()), this, SLOT(diagnostics()));
+
   newNoteAction = new QAction(tr("New &Note"), this);
   newNoteAction->setShortcut(tr("Ctrl+N"));
   connect(newNoteAction, SIGNAL(triggered()), this, SLOT(newNote()));
@@ -504,6 +533,8 @@ void PumpApp::createMenu() {
   helpMenu = new QMenu(tr("&Help"), this);
   helpMenu->addAction(aboutAction);
   helpMenu->addAction(aboutQtAction);
+  helpMenu->addSeparator();
+  helpMenu->addAction(diagnosticsAction);
   menuBar()->addMenu(helpMenu);
 }
 
@@ -873,8 +904,9 @@ void PumpApp::uploadFile(QString filename) {
   m_uploadDialog->show();
 
   const QNetworkReply* nr = executeRequest(oaRequest, QAS_IMAGE_UPLOAD);
-  connect(nr, SIGNAL(uploadProgress(qint64, qint64)),
-          this, SLOT(uploadProgress(qint64, qint64)));
+  if (nr)
+    connect(nr, SIGNAL(uploadProgress(qint64, qint64)),
+            this, SLOT(uploadProgress(qint64, qint64)));
 }
 
 //------------------------------------------------------------------------------
@@ -1069,19 +1101,55 @@ void PumpApp::request(QString endpoint, int response_id,
 
 //------------------------------------------------------------------------------
 
+int PumpApp::endpointClass(QString endpoint, int response_id) {
+  if (endpoint == m_s->firehoseUrl())
+    return PerfStats::Firehose;
+  if (endpoint.contains("/inbox"))
+    return PerfStats::Inbox;
+  if ((response_id & 0xFF) == QAS_OBJECT)
+    return PerfStats::ObjectRefresh;
+  return PerfStats::Other;
+}
+
+//------------------------------------------------------------------------------
+
 QNetworkReply* PumpApp::executeRequest(KQOAuthRequest* request,
                                        int response_id) {
   int id = m_nextRequestId++;
 
+  RequestTimer* timer =
+    new RequestTimer(endpointClass(request->requestEndpoint().toString(),
+                                   response_id), this);
+
   m_requestMap.insert(id, qMakePair(request, response_id));
-  oaManager->executeAuthorizedRequest(request, id);
+  if (!oaManager->executeAuthorizedRequest(request, id)) {
+    delete timer;
+    m_requestMap.remove(id);
+    errorMessage(QString(tr("Unable to send request [%1/%2] %3.")).
+                 arg(oaManager->lastError()).arg(response_id).
+                 arg(request->requestEndpoint().toString()));
+    request->deleteLater();
+    return NULL;
+  }
+
+  QNetworkReply* reply = oaManager->getReply(request);
+  timer->setReply(reply);
+  m_requestTimers.insert(id, timer);
+
+  // Request ids are reused, but never while still in flight
+  if (TraceLog::active())
+    TraceLog::asyncBegin("request", "request", id,
+                         request->requestEndpoint().toString());
 
-  return oaManager->getReply(request);
+  return reply;
 }
 
 //------------------------------------------------------------------------------
 
-void PumpApp::onAuthorizedRequestReady(QByteArray response, int rid) {
+void PumpApp::onAuthorizedRequestReady(QByteArray response, int rid,
+                                       KQOAuthManager::KQOAuthError error) {
+  ProfileScope profileScope("PumpApp::onAuthorizedRequestReady", "network");
+
   QPair<KQOAuthRequest*, int> rp = m_requestMap.take(rid);
   KQOAuthRequest* request = rp.first;
   int id = rp.second;
@@ -1089,6 +1157,18 @@ void PumpApp::onAuthorizedRequestReady(QByteArray response, int rid) {
     m_nextRequestId = rid;
   QString reqUrl = request->requestEndpoint().toString();
 
+  RequestTimer* timer = m_requestTimers.take(rid);
+  if (timer)
+    timer->replyFinished();
+
+  if (TraceLog::active())
+    TraceLog::asyncEnd("request", "request", rid,
+                       QString("%1 bytes, error %2").arg(response.size()).
+                       arg(error));
+
+  if (TrafficRecorder::active())
+    recordResponse(request, id, error, response, timer);
+
 #ifdef DEBUG_NET
   qDebug() << "[DEBUG] request done [" << rid << id << "]" << reqUrl
            << response.count() << "bytes";
@@ -1097,14 +1177,14 @@ void PumpApp::onAuthorizedRequestReady(QByteArray response, int rid) {
   qDebug() << response;
 #endif
 
+  QString orderKey = request->requestEndpoint().toString(QUrl::RemoveQuery);
   request->deleteLater();
 
-  if (m_requestMap.isEmpty())
-    notifyMessage(tr("Ready!"));
-
   int sid = id & 0xFF;
 
-  if (oaManager->lastError()) {
+  if (error) {
+    // Before the error, so that it doesn't get overwritten
+    notifyIfReady();
     if (id & QAS_POST) {
       errorMessage(tr("Unable to post message!"));
       m_messageWindow->show();
@@ -1112,14 +1192,42 @@ void PumpApp::onAuthorizedRequestReady(QByteArray response, int rid) {
       qDebug() << "[WARNING] unable to fetch context for object.";
     } else {
       errorMessage(QString(tr("Network or authorisation error [%1/%2] %3.")).
-                   arg(oaManager->lastError()).arg(id).arg(reqUrl));
+                   arg(error).arg(id).arg(reqUrl));
     }
+    if (timer)
+      timer->deleteLater();
     return;
   }
 
-  QVariantMap json = parseJson(response);
-  if (sid == QAS_NULL)
+  if (response.isEmpty() || sid == QAS_NULL) {
+    if (timer)
+      timer->finish();
+    notifyIfReady();
     return;
+  }
+
+  // Parsed on a worker thread, the model is updated in
+  // onResponseParsed() once it's done.
+  m_responseWorker->parse(orderKey, response, rid, id, reqUrl, timer);
+}
+
+//------------------------------------------------------------------------------
+
+void PumpApp::onResponseParsed(const ParsedResponse& r) {
+  ProfileScope profileScope("PumpApp::onResponseParsed", "model");
+
+  const QVariantMap& json = r.json;
+  int id = r.responseId;
+  int sid = id & 0xFF;
+  RequestTimer* timer = r.timer;
+
+  if (timer) {
+    timer->mark(PerfStats::Parse);
+    timer->beginModel();
+  }
+
+  TraceLog::begin("model update", "model");
+  QASAbstractObject::beginResponse(&r.fingerprints);
 
   if (sid == QAS_COLLECTION) {
     QASCollection* coll = QASCollection::getCollection(json, this, id);
@@ -1138,7 +1246,7 @@ void PumpApp::onAuthorizedRequestReady(QByteArray response, int rid) {
 
         if (checkFollows) {
           QASActor* actor = activity->actor();
-          if (activity->verb() == "post" && actor &&
+          if (activity->verbId() == QASActivity::PostVerb && actor &&
               actor->followedJson() && !actor->followed()) {
             actor->setFollowed(true);
             // qDebug() << "[WARNING] Setting followed "
@@ -1187,12 +1295,51 @@ void PumpApp::onAuthorizedRequestReady(QByteArray response, int rid) {
     updatePostedImage(json);
   }
 
+  QASAbstractObject::endResponse();
+  TraceLog::end("model update", "model");
+
+  if (timer) {
+    timer->endModel();
+    timer->finishAfterWidgets();
+  }
+
   if ((id & QAS_POST) && m_messageWindow)
     m_messageWindow->clear();
 
   if (id & QAS_REFRESH) { 
     fetchAll();
   }
+
+  notifyIfReady();
+}
+
+//------------------------------------------------------------------------------
+
+void PumpApp::notifyIfReady() {
+  if (m_requestMap.isEmpty() && !m_responseWorker->busy())
+    notifyMessage(tr("Ready!"));
+}
+
+//------------------------------------------------------------------------------
+
+void PumpApp::recordResponse(KQOAuthRequest* request, int id,
+                             KQOAuthManager::KQOAuthError error,
+                             const QByteArray& response,
+                             RequestTimer* timer) {
+  QString endpoint = request->requestEndpoint().toString();
+
+  KQOAuthParameters params = request->additionalParameters();
+  QStringList query;
+  for (KQOAuthParameters::const_iterator it = params.constBegin();
+       it != params.constEnd(); ++it)
+    query << it.key() + "=" + QUrl::toPercentEncoding(it.value());
+  if (!query.isEmpty())
+    endpoint += "?" + query.join("&");
+
+  bool post = request->httpMethod() == KQOAuthRequest::POST;
+  TrafficRecorder::record(post ? "POST" : "GET", endpoint, id, error,
+                          response, timer ? timer->elapsed() : -1,
+                          post ? request->rawData() : QByteArray());
 }
 
 //------------------------------------------------------------------------------
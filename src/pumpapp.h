@@ -48,6 +48,9 @@
 #include "contextwidget.h"
 #include "objectlistwidget.h"
 #include "messagewindow.h"
+#include "perfstats.h"
+#include "diagnosticsdialog.h"
+#include "responseworker.h"
 
 //------------------------------------------------------------------------------
 
@@ -89,7 +92,9 @@ private slots:
   void onClientRegistered(QString, QString, QString, QString);
   void onAccessTokenReceived(QString token, QString tokenSecret);
 
-  void onAuthorizedRequestReady(QByteArray response, int id);
+  void onAuthorizedRequestReady(QByteArray response, int id,
+                                KQOAuthManager::KQOAuthError error);
+  void onResponseParsed(const ParsedResponse& r);
 
   void uploadProgress(qint64 bytesSent, qint64 bytesTotal);
   
@@ -110,6 +115,7 @@ private slots:
   void launchOAuthWizard();
 
   void debugAction();
+  void diagnostics();
 
 protected:
   void timerEvent(QTimerEvent*);
@@ -127,8 +133,16 @@ private:
   KQOAuthRequest* initRequest(QString endpoint,
                               KQOAuthRequest::RequestHttpMethod method);
   QNetworkReply* executeRequest(KQOAuthRequest* request, int response_id);
+  // Says so in the status bar once no requests or responses are left.
+  void notifyIfReady();
 
   QMap<int, QPair<KQOAuthRequest*, int> > m_requestMap;
+  QMap<int, RequestTimer*> m_requestTimers;
+  ResponseWorker* m_responseWorker;
+  int endpointClass(QString endpoint, int response_id);
+  void recordResponse(KQOAuthRequest* request, int id,
+                      KQOAuthManager::KQOAuthError error,
+                      const QByteArray& response, RequestTimer* timer);
   int m_nextRequestId;
 
   void refreshObject(QASAbstractObject* obj);
@@ -192,8 +206,11 @@ private:
 
   QAction* aboutAction;
   QAction* aboutQtAction;
+  QAction* diagnosticsAction;
   QMenu* helpMenu;
 
+  DiagnosticsDialog* m_diagnosticsDialog;
+
   QAction* m_debugAction;
 
   KQOAuthManager *oaManager;
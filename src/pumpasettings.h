@@ -94,6 +94,16 @@ public:
     return getValue("max_timeline_items", 40).toInt();
   }
 
+  // How many screenfuls ahead of the scroll position to download
+  // images.
+  int imagePrefetchPages() const {
+    return getValue("image_prefetch_pages", 1).toInt();
+  }
+
+  bool dedupeImageCache() const {
+    return getValue("dedupe_image_cache", true).toBool();
+  }
+
   // setters
   void siteUrl(QString s) { setValue("site_url", s, "Account"); }
   void userName(QString s) { setValue("username", s, "Account"); }
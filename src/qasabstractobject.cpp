@@ -20,17 +20,30 @@
 //------------------------------------------------------------------------------
 
 #include "qasabstractobject.h"
+#include "util.h"
+
+#include <QDebug>
+
+//------------------------------------------------------------------------------
+
+bool QASAbstractObject::s_memoActive = false;
+QMap<QString, QSet<quint64> > QASAbstractObject::s_memo;
+qulonglong QASAbstractObject::s_memoLookups = 0;
+qulonglong QASAbstractObject::s_memoHits = 0;
+const JsonFingerprints* QASAbstractObject::s_fingerprints = NULL;
 
 //------------------------------------------------------------------------------
 
 QDateTime parseTime(QString timeStr) {
   // 2013-05-28T16:43:06Z 
-  // 55 minutes ago kl. 20:39 -> 19:44
+  bool ok = false;
+  qint64 msecs = parseIsoTime(timeStr, &ok);
+  if (!ok)
+    return QDateTime();
 
-  QDateTime dt = QDateTime::fromString(timeStr, Qt::ISODate); 
-                                       // "yyyy-MM-ddThh:mm:ssZ");
+  QDateTime dt;
   dt.setTimeSpec(Qt::UTC);
-
+  dt.setMSecsSinceEpoch(msecs);
   return dt;
 }
 
@@ -38,7 +51,8 @@ QDateTime parseTime(QString timeStr) {
 
 QASAbstractObject::QASAbstractObject(int asType, QObject* parent) :
   QObject(parent),
-  m_asType(asType) 
+  m_asType(asType),
+  m_jsonFingerprint(0)
 {}
 
 //------------------------------------------------------------------------------
@@ -69,6 +83,64 @@ void QASAbstractObject::connectSignals(QASAbstractObject* obj,
 
 //------------------------------------------------------------------------------
 
+void QASAbstractObject::beginResponse(const JsonFingerprints* fps) {
+  s_memo.clear();
+  s_memoActive = true;
+  s_fingerprints = fps;
+}
+
+//------------------------------------------------------------------------------
+
+void QASAbstractObject::endResponse() {
+  s_memo.clear();
+  s_memoActive = false;
+  s_fingerprints = NULL;
+#ifdef DEBUG_QAS
+  qDebug() << "memo hits" << s_memoHits << "of" << s_memoLookups;
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+bool QASAbstractObject::alreadyUpdated(QString id, const QVariantMap& json,
+                                       bool ignoreLike) {
+  if (!s_memoActive)
+    return false;
+  s_memoLookups++;
+
+  // The same object can be embedded several times, e.g. a bare actor
+  // in "likes" and a full one as the author, or with newer counts
+  // further down. Only skip occurrences identical to one already
+  // applied for this id.
+  quint64 fp = lookupJsonFingerprint(json, s_fingerprints) +
+    (ignoreLike ? 1 : 0);
+
+  QMap<QString, QSet<quint64> >::iterator it = s_memo.find(id);
+  if (it == s_memo.end())
+    it = s_memo.insert(id, QSet<quint64>());
+
+  if (it.value().contains(fp)) {
+    s_memoHits++;
+    return true;
+  }
+
+  it.value().insert(fp);
+  return false;
+}
+
+//------------------------------------------------------------------------------
+
+bool QASAbstractObject::sameJson(const QVariantMap& json, int salt) {
+  quint64 fp = lookupJsonFingerprint(json, s_fingerprints) + salt;
+  if (m_jsonFingerprint == fp)
+    return true;
+
+  m_jsonFingerprint = fp;
+  return false;
+}
+
+//------------------------------------------------------------------------------
+
 void QASAbstractObject::updateVar(QVariantMap obj, QString& var, QString name, 
                                   bool& changed) {
   QString oldVar = var;
@@ -150,6 +222,11 @@ void QASAbstractObject::updateUrlOrProxy(QVariantMap obj, QString& var,
   updateVar(obj, var, "url", dummy);
   updateVar(obj, var, "pump_io", "proxyURL", dummy);
 
+  // Lets the image be cached under its own URL whichever one we
+  // download it from.
+  addImageUrlAlias(obj["pump_io"].toMap()["proxyURL"].toString(),
+                   obj["url"].toString());
+
   if (oldVar.contains("/api/proxy/") && !var.contains("/api/proxy/"))
     var = oldVar;
 
@@ -23,12 +23,18 @@
 #include <QObject>
 #include <QDateTime>
 #include <QVariantMap>
+#include <QSet>
 
 #include "pumpa_defines.h"
 #include "json.h"
 
 //------------------------------------------------------------------------------
 
+// Parses a pump.io timestamp, returns a null QDateTime if invalid.
+QDateTime parseTime(QString timeStr);
+
+//------------------------------------------------------------------------------
+
 class QASAbstractObject : public QObject {
   Q_OBJECT
 
@@ -38,9 +44,22 @@ public:
   int asType() const { return m_asType; }
   virtual bool isDeleted() const { return false; }
 
+  // Estimated bytes held by this object, not counting other cached
+  // objects it points to.
+  virtual qint64 memoryUsage() const { return sizeof(QASAbstractObject); }
+
   QDateTime lastRefreshed() const { return m_lastRefreshed; }
   void lastRefreshed(QDateTime dt) { m_lastRefreshed = dt; }
 
+  // While a network response is being applied to the model, later
+  // occurrences of an embedded object with the same id and identical
+  // JSON just resolve the cached pointer. fps are the
+  // fingerprints collected from the response, if any.
+  static void beginResponse(const JsonFingerprints* fps = NULL);
+  static void endResponse();
+  static qulonglong memoLookups() { return s_memoLookups; }
+  static qulonglong memoHits() { return s_memoHits; }
+
 signals:
   void changed();
   // void request(QString, int);
@@ -64,8 +83,24 @@ protected:
   static void addVar(QVariantMap&, QString, QString);
   static void updateUrlOrProxy(QVariantMap, QString&, bool&);
 
+  static bool alreadyUpdated(QString id, const QVariantMap& json,
+                             bool ignoreLike=false);
+
+  // Returns true if json is identical to what this object was last
+  // updated from, otherwise remembers its fingerprint.
+  bool sameJson(const QVariantMap& json, int salt=0);
+  void forgetJson() { m_jsonFingerprint = 0; }
+
   QDateTime m_lastRefreshed;
   int m_asType;
+  quint64 m_jsonFingerprint;
+
+private:
+  static bool s_memoActive;
+  static QMap<QString, QSet<quint64> > s_memo;
+  static qulonglong s_memoLookups;
+  static qulonglong s_memoHits;
+  static const JsonFingerprints* s_fingerprints;
 };
 
 #endif /* _QASABSTRACTOBJECT_H_ */
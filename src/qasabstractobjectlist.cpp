@@ -166,3 +166,12 @@ void QASAbstractObjectList::removeObject(QASAbstractObject* obj, bool signal) {
   if (signal)
     emit changed();
 }
+
+//------------------------------------------------------------------------------
+
+qint64 QASAbstractObjectList::memoryUsage() const {
+  // a list slot plus a hash node for each item
+  return sizeof(QASAbstractObjectList) + stringBytes(m_displayName) +
+    stringBytes(m_url) + stringBytes(m_proxyUrl) + stringBytes(m_prevLink) +
+    stringBytes(m_nextLink) + m_items.size()*4*sizeof(void*);
+}
@@ -60,6 +60,8 @@ public:
     return m_item_set.contains(obj);
   }
 
+  virtual qint64 memoryUsage() const;
+
 protected:
   virtual QASAbstractObject* getAbstractObject(QVariantMap json,
                                                QObject* parent) = 0;
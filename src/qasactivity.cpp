@@ -21,6 +21,7 @@
 #include "util.h"
 
 #include <QDebug>
+#include <QHash>
 
 //------------------------------------------------------------------------------
 
@@ -28,11 +29,33 @@ QMap<QString, QASActivity*> QASActivity::s_activities;
 
 void QASActivity::clearCache() { deleteMap<QASActivity*>(s_activities); }
 
+qint64 QASActivity::cacheBytes() { return mapMemoryUsage(s_activities); }
+
+//------------------------------------------------------------------------------
+
+int QASActivity::verbFromString(const QString& verb) {
+  static QHash<QString, int> verbs;
+  if (verbs.isEmpty()) {
+    verbs.insert("post", PostVerb);
+    verbs.insert("share", ShareVerb);
+    verbs.insert("like", LikeVerb);
+    verbs.insert("favorite", LikeVerb);
+    verbs.insert("unlike", UnlikeVerb);
+    verbs.insert("unfavorite", UnlikeVerb);
+    verbs.insert("follow", FollowVerb);
+    verbs.insert("stop-following", StopFollowingVerb);
+    verbs.insert("update", UpdateVerb);
+    verbs.insert("delete", DeleteVerb);
+  }
+  return verbs.value(verb, UnknownVerb);
+}
+
 //------------------------------------------------------------------------------
 
 QASActivity::QASActivity(QString id, QObject* parent) : 
   QASAbstractObject(QAS_ACTIVITY, parent),
   m_id(id),
+  m_verbId(UnknownVerb),
   m_object(NULL),
   m_actor(NULL),
   m_to(NULL),
@@ -52,6 +75,7 @@ void QASActivity::update(QVariantMap json) {
   bool ch = false;
 
   updateVar(json, m_verb, "verb", ch);
+  m_verbId = verbFromString(m_verb);
   updateVar(json, m_url, "url", ch);
   updateVar(json, m_content, "content", ch);
   
@@ -62,7 +86,7 @@ void QASActivity::update(QVariantMap json) {
 
   if (json.contains("object")) {
     m_object = QASObject::getObject(json["object"].toMap(), parent(),
-                                    isLikeVerb(m_verb));
+                                    isLikeVerb());
     //connectSignals(m_object);
     if (!m_object->author())
       m_object->setAuthor(m_actor);
@@ -72,20 +96,20 @@ void QASActivity::update(QVariantMap json) {
   updateVar(json, m_updated, "updated", ch);
   updateVar(json, m_generatorName, "generator", "displayName", ch);
 
-  if (m_verb == "post" && m_object && m_object->inReplyTo())
+  if (m_verbId == PostVerb && m_object && m_object->inReplyTo())
     m_object->inReplyTo()->addReply(m_object);
 
-  if (isLikeVerb(m_verb) && m_object && m_actor) 
-    m_object->addLike(m_actor, !m_verb.startsWith("un"));
+  if (isLikeVerb() && m_object && m_actor) 
+    m_object->addLike(m_actor, m_verbId == LikeVerb);
 
-  if (m_verb == "share" && m_object && m_actor) 
+  if (m_verbId == ShareVerb && m_object && m_actor) 
     m_object->addShare(m_actor);
 
   if (json.contains("to"))
-    m_to = QASObjectList::getObjectList(json["to"].toList(), parent());
+    m_to = QASObjectList::getRecipientList(json["to"].toList(), parent());
 
   if (json.contains("cc"))
-    m_cc = QASObjectList::getObjectList(json["cc"].toList(), parent());
+    m_cc = QASObjectList::getRecipientList(json["cc"].toList(), parent());
 
   if (ch)
     emit changed();
@@ -101,7 +125,8 @@ QASActivity* QASActivity::getActivity(QVariantMap json, QObject* parent) {
     new QASActivity(id, parent);
   s_activities.insert(id, act);
 
-  act->update(json);
+  if (!act->sameJson(json))
+    act->update(json);
   return act;
 }
 
@@ -117,3 +142,10 @@ bool QASActivity::hasCc() const {
   return m_cc && m_cc->size(); 
 }
 
+//------------------------------------------------------------------------------
+
+qint64 QASActivity::memoryUsage() const {
+  return sizeof(QASActivity) + stringBytes(m_id) + stringBytes(m_url) +
+    stringBytes(m_content) + stringBytes(m_verb) +
+    stringBytes(m_generatorName);
+}
@@ -34,7 +34,15 @@ class QASActivity : public QASAbstractObject {
   QASActivity(QString id, QObject* parent);
 
 public:
+  enum Verb { UnknownVerb = 0, PostVerb, ShareVerb, LikeVerb, UnlikeVerb,
+              FollowVerb, StopFollowingVerb, UpdateVerb, DeleteVerb };
+
+  // "favorite" and "unfavorite" map to LikeVerb and UnlikeVerb
+  static int verbFromString(const QString& verb);
+
   static void clearCache();
+  static int cacheItems() { return s_activities.count(); }
+  static qint64 cacheBytes();
 
   static QASActivity* getActivity(QVariantMap json, QObject* parent);
   void update(QVariantMap json);
@@ -43,6 +51,7 @@ public:
 
   QString id() const { return m_id; }
   QString verb() const { return m_verb; }
+  int verbId() const { return m_verbId; }
   QString content() const { return m_content; }
   QString generatorName() const { return m_generatorName; }
 
@@ -60,20 +69,23 @@ public:
   QASObjectList* to() const { return m_to; }
   QASObjectList* cc() const { return m_cc; }
 
-  static bool isLikeVerb(QString verb) {
-    return (verb == "favorite" || verb == "like" ||
-            verb == "unfavorite" || verb == "unlike");
+  static bool isLikeVerb(int verbId) {
+    return verbId == LikeVerb || verbId == UnlikeVerb;
   }
+  bool isLikeVerb() const { return isLikeVerb(m_verbId); }
 
   virtual bool isDeleted() const { 
-    return m_verb == "post" && m_object && m_object->isDeleted();
+    return m_verbId == PostVerb && m_object && m_object->isDeleted();
   }
 
+  virtual qint64 memoryUsage() const;
+
 private:
   QString m_id;
   QString m_url;
   QString m_content;
   QString m_verb;
+  int m_verbId;
   QString m_generatorName;
 
   QDateTime m_published;
@@ -18,6 +18,7 @@
 */
 
 #include "qasactor.h"
+#include "util.h"
 
 #include <QRegExp>
 #include <QDebug>
@@ -56,6 +57,7 @@ void QASActor::update(QVariantMap json) {
   updateVar(json, m_url, "url", ch); 
   updateVar(json, m_displayName, "displayName", ch);
   updateVar(json, m_objectType, "objectType", ch);
+  m_typeId = typeFromString(m_objectType);
   updateVar(json, m_preferredUsername, "preferredUsername", ch);
 
   // this seems to be unreliable
@@ -87,7 +89,8 @@ QASActor* QASActor::getActor(QVariantMap json, QObject* parent) {
     qobject_cast<QASActor*>(s_objects[id]) : new QASActor(id, parent);
   s_objects.insert(id, act);
 
-  act->update(json);
+  if (!alreadyUpdated(id, json) && !act->sameJson(json))
+    act->update(json);
   return act;
 }
 
@@ -108,3 +111,11 @@ QString QASActor::displayNameOrWebFinger() const {
   return displayName();
 }
 
+//------------------------------------------------------------------------------
+
+qint64 QASActor::memoryUsage() const {
+  return QASObject::memoryUsage() + sizeof(QASActor) - sizeof(QASObject) +
+    stringBytes(m_summary) + stringBytes(m_location) +
+    stringBytes(m_webFinger) + stringBytes(m_webFingerName) +
+    stringBytes(m_preferredUsername);
+}
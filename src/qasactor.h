@@ -51,6 +51,8 @@ public:
   QString summary() const { return m_summary; }
   QString location() const { return m_location; }
 
+  virtual qint64 memoryUsage() const;
+
 private:
   bool m_followed;
   bool m_followed_json;
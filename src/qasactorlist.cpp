@@ -28,6 +28,8 @@
 QMap<QString, QASActorList*> QASActorList::s_actorLists;
 void QASActorList::clearCache() { deleteMap<QASActorList*>(s_actorLists); }
 
+qint64 QASActorList::cacheBytes() { return mapMemoryUsage(s_actorLists); }
+
 //------------------------------------------------------------------------------
 
 QASActorList::QASActorList(QString url, QObject* parent) :
@@ -30,6 +30,8 @@ protected:
 
 public:
   static void clearCache();
+  static int cacheItems() { return s_actorLists.count(); }
+  static qint64 cacheBytes();
 
   static QASActorList* getActorList(QVariantMap json, QObject* parent,
                                     int id=0);
@@ -29,6 +29,8 @@ QMap<QString, QASCollection*> QASCollection::s_collections;
 
 void QASCollection::clearCache() { deleteMap<QASCollection*>(s_collections); }
 
+qint64 QASCollection::cacheBytes() { return mapMemoryUsage(s_collections); }
+
 //------------------------------------------------------------------------------
 
 QASCollection::QASCollection(QString url, QObject* parent) :
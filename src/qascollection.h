@@ -34,6 +34,8 @@ protected:
 
 public:
   static void clearCache();
+  static int cacheItems() { return s_collections.count(); }
+  static qint64 cacheBytes();
 
   static QASCollection* initCollection(QString url, QObject* parent);
   static QASCollection* getCollection(QVariantMap json, QObject* parent,
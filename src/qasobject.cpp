@@ -25,6 +25,7 @@
 #include "util.h"
 
 #include <QDebug>
+#include <QHash>
 #include <QList>
 #include <QtAlgorithms>
 
@@ -34,6 +35,8 @@ QMap<QString, QASObject*> QASObject::s_objects;
 
 void QASObject::clearCache() { deleteMap<QASObject*>(s_objects); }
 
+qint64 QASObject::cacheBytes() { return mapMemoryUsage(s_objects); }
+
 int QASObject::objectsUnconnected() {
   int noConnections = 0;
   QMap<int, int> hist;
@@ -62,11 +65,32 @@ int QASObject::connections() const {
 
 //------------------------------------------------------------------------------
 
+int QASObject::typeFromString(const QString& objectType) {
+  static QHash<QString, int> types;
+  if (types.isEmpty()) {
+    types.insert("person", PersonType);
+    types.insert("note", NoteType);
+    types.insert("comment", CommentType);
+    types.insert("image", ImageType);
+    types.insert("collection", CollectionType);
+    types.insert("video", VideoType);
+    types.insert("audio", AudioType);
+    types.insert("file", FileType);
+    types.insert("place", PlaceType);
+    types.insert("group", GroupType);
+    types.insert("bookmark", BookmarkType);
+  }
+  return types.value(objectType, UnknownType);
+}
+
+//------------------------------------------------------------------------------
+
 QASObject::QASObject(QString id, QObject* parent) :
   QASAbstractObject(QAS_OBJECT, parent),
   m_id(id),
   m_liked(false),
   m_shared(false),
+  m_typeId(UnknownType),
   m_inReplyTo(NULL),
   m_author(NULL),
   m_replies(NULL),
@@ -88,6 +112,7 @@ void QASObject::update(QVariantMap json, bool ignoreLike) {
   bool wasDeleted = isDeleted();
 
   updateVar(json, m_objectType, "objectType", ch);
+  m_typeId = typeFromString(m_objectType);
   updateVar(json, m_url, "url", ch);
   updateVar(json, m_content, "content", ch);
   if (!ignoreLike)
@@ -95,7 +120,7 @@ void QASObject::update(QVariantMap json, bool ignoreLike) {
   updateVar(json, m_displayName, "displayName", ch);
   updateVar(json, m_shared, "pump_io", "shared", ch);
 
-  if (m_objectType == "image" && json.contains("image")) {
+  if (m_typeId == ImageType && json.contains("image")) {
     updateUrlOrProxy(json["image"].toMap(), m_imageUrl, ch);
 
     if (json.contains("fullImage"))
@@ -158,14 +183,16 @@ QASObject* QASObject::getObject(QVariantMap json, QObject* parent,
   QString id = json["id"].toString();
   Q_ASSERT_X(!id.isEmpty(), "getObject", serializeJsonC(json));
 
-  if (json["objectType"] == "person")
+  if (typeFromString(json["objectType"].toString()) == PersonType)
     return QASActor::getActor(json, parent);
 
   QASObject* obj = s_objects.contains(id) ?  s_objects[id] :
     new QASObject(id, parent);
   s_objects.insert(id, obj);
 
-  obj->update(json, ignoreLike);
+  if (!alreadyUpdated(id, json, ignoreLike) &&
+      !obj->sameJson(json, ignoreLike ? 1 : 0))
+    obj->update(json, ignoreLike);
   return obj;
 }
 
@@ -178,6 +205,7 @@ void QASObject::addReply(QASObject* obj) {
     // connectSignals(m_replies);
   }
   m_replies->addObject(obj);
+  forgetJson();
 #ifdef DEBUG_QAS
   qDebug() << "addReply" << obj->id() << "to" << id();
 #endif
@@ -188,6 +216,7 @@ void QASObject::addReply(QASObject* obj) {
 
 void QASObject::toggleLiked() { 
   m_liked = !m_liked; 
+  forgetJson();
   emit changed();
 }
 
@@ -206,6 +235,7 @@ void QASObject::addLike(QASActor* actor, bool like) {
     m_likes->addActor(actor);
   else
     m_likes->removeActor(actor);
+  forgetJson();
 }
 
 //------------------------------------------------------------------------------
@@ -214,6 +244,7 @@ void QASObject::addShare(QASActor* actor) {
   if (!m_shares)
     return;
   m_shares->addActor(actor);
+  forgetJson();
 }
 
 //------------------------------------------------------------------------------
@@ -259,3 +290,11 @@ QASActor* QASObject::asActor() {
   return qobject_cast<QASActor*>(this);
 }
 
+//------------------------------------------------------------------------------
+
+qint64 QASObject::memoryUsage() const {
+  return sizeof(QASObject) + stringBytes(m_id) + stringBytes(m_content) +
+    stringBytes(m_objectType) + stringBytes(m_url) + stringBytes(m_imageUrl) +
+    stringBytes(m_fullImageUrl) + stringBytes(m_displayName) +
+    stringBytes(m_apiLink) + stringBytes(m_proxyUrl);
+}
@@ -35,8 +35,17 @@ protected:
   QASObject(QString id, QObject* parent);
 
 public:
+  // objectType atoms, anything not listed here is UnknownType and
+  // only available through type()
+  enum ObjectType { UnknownType = 0, PersonType, NoteType, CommentType,
+                    ImageType, CollectionType, VideoType, AudioType,
+                    FileType, PlaceType, GroupType, BookmarkType };
+
+  static int typeFromString(const QString& objectType);
+
   static void clearCache();
   static int cacheItems() { return s_objects.count(); }
+  static qint64 cacheBytes();
   static int objectsUnconnected();
 
   int connections() const;
@@ -55,6 +64,7 @@ public:
   QString id() const { return m_id; }
   QString content() const { return m_content; }
   QString type() const { return m_objectType; }
+  int typeId() const { return m_typeId; }
   QString url() const { return m_url; }
   QString imageUrl() const { return m_imageUrl; }
   QString fullImageUrl() const { return m_fullImageUrl; }
@@ -89,12 +99,15 @@ public:
 
   virtual bool isDeleted() const { return !m_deleted.isNull(); }
 
+  virtual qint64 memoryUsage() const;
+
 protected:
   QString m_id;
   QString m_content;
   bool m_liked;
   bool m_shared;
   QString m_objectType;
+  int m_typeId;
   QString m_url;
   QString m_imageUrl;
   QString m_fullImageUrl;
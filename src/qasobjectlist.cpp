@@ -23,11 +23,23 @@
 #include "util.h"
 
 #include <QDebug>
+#include <QStringList>
 
 //------------------------------------------------------------------------------
 
 QMap<QString, QASObjectList*> QASObjectList::s_objectLists;
-void QASObjectList::clearCache() { deleteMap<QASObjectList*>(s_objectLists); }
+QMap<QString, QASObjectList*> QASObjectList::s_recipientLists;
+
+void QASObjectList::clearCache() {
+  deleteMap<QASObjectList*>(s_objectLists);
+  deleteMap<QASObjectList*>(s_recipientLists);
+}
+
+qint64 QASObjectList::cacheBytes() { return mapMemoryUsage(s_objectLists); }
+
+qint64 QASObjectList::recipientListBytes() {
+  return mapMemoryUsage(s_recipientLists);
+}
 
 //------------------------------------------------------------------------------
 
@@ -44,7 +56,8 @@ QASObjectList::QASObjectList(QString url, QObject* parent) :
 
 QASAbstractObject* QASObjectList::getAbstractObject(QVariantMap json,
                                                     QObject* parent) {
-  if (json["objectType"].toString() == "person")
+  if (QASObject::typeFromString(json["objectType"].toString()) ==
+      QASObject::PersonType)
     return QASActor::getActor(json, parent);
   return QASObject::getObject(json, parent);
 }
@@ -92,6 +105,32 @@ QASObjectList* QASObjectList::getObjectList(QVariantList json, QObject* parent,
 
 //------------------------------------------------------------------------------
 
+QASObjectList* QASObjectList::getRecipientList(QVariantList json,
+                                               QObject* parent) {
+  QStringList ids;
+  for (int i=0; i<json.count(); i++)
+    ids << json.at(i).toMap()["id"].toString();
+  QString key = ids.join(" ");
+
+  if (s_recipientLists.contains(key))
+    return s_recipientLists[key];
+
+  QASObjectList* rl = new QASObjectList("", parent);
+  s_recipientLists.insert(key, rl);
+
+  QVariantMap jmap;
+  jmap["totalItems"] = json.size();
+  jmap["items"] = json;
+  rl->update(jmap, false);
+
+#ifdef DEBUG_QAS
+  qDebug() << "new RecipientList" << key;
+#endif
+  return rl;
+}
+
+//------------------------------------------------------------------------------
+
 void QASObjectList::update(QVariantMap json, bool older) {
   if (m_isReplies && json.contains("items")) {
     m_item_set.clear();
@@ -44,6 +44,17 @@ public:
   static QASObjectList* getObjectList(QVariantList json, QObject* parent, 
                                       int id=0);
 
+  // Recipient lists (to, cc) have no url of their own, so instead of
+  // creating a new list for every activity they are interned by the
+  // ids of their items and shared. They are never updated after
+  // creation.
+  static QASObjectList* getRecipientList(QVariantList json, QObject* parent);
+  static int recipientListCount() { return s_recipientLists.count(); }
+  static qint64 recipientListBytes();
+
+  static int cacheItems() { return s_objectLists.count(); }
+  static qint64 cacheBytes();
+
   QASObject* at(size_t i) const {
     return qobject_cast<QASObject*>(QASAbstractObjectList::at(i));
   }
@@ -56,6 +67,7 @@ protected:
 
 private:
   static QMap<QString, QASObjectList*> s_objectLists;
+  static QMap<QString, QASObjectList*> s_recipientLists;
   bool m_isReplies;
 };
 
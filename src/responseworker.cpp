@@ -0,0 +1,113 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "responseworker.h"
+#include "json.h"
+#include "tracelog.h"
+
+#include <QRunnable>
+
+//------------------------------------------------------------------------------
+
+class ParseTask : public QRunnable {
+public:
+  ParseTask(ResponseWorker* worker, ResponseWorker::Job* job) :
+    m_worker(worker), m_job(job) {}
+
+  void run() {
+    ParsedResponse& r = m_job->response;
+    {
+      ProfileScope parseScope("parseJson", "parse");
+      r.json = parseJson(r.data);
+    }
+    {
+      ProfileScope fingerprintScope("collectJsonFingerprints", "parse");
+      collectJsonFingerprints(r.json, r.fingerprints);
+    }
+    r.data.clear();
+
+    QMetaObject::invokeMethod(m_worker, "onTaskDone", Qt::QueuedConnection,
+                              Q_ARG(void*, m_job));
+  }
+
+private:
+  ResponseWorker* m_worker;
+  ResponseWorker::Job* m_job;
+};
+
+//------------------------------------------------------------------------------
+
+ResponseWorker::ResponseWorker(QObject* parent) : QObject(parent) {
+  m_pool = new QThreadPool(this);
+}
+
+//------------------------------------------------------------------------------
+
+ResponseWorker::~ResponseWorker() {
+  // Tasks refer to the jobs, so they have to finish first. Their
+  // queued onTaskDone() calls are dropped with this object.
+  m_pool->waitForDone();
+
+  QMap<QString, QList<Job*> >::iterator it;
+  for (it = m_queues.begin(); it != m_queues.end(); ++it)
+    qDeleteAll(it.value());
+}
+
+//------------------------------------------------------------------------------
+
+void ResponseWorker::parse(QString key, const QByteArray& data,
+                           int requestId, int responseId, QString url,
+                           RequestTimer* timer) {
+  Job* job = new Job;
+  job->key = key;
+  job->done = false;
+  job->response.requestId = requestId;
+  job->response.responseId = responseId;
+  job->response.url = url;
+  job->response.timer = timer;
+  job->response.data = data;
+
+  m_queues[key].append(job);
+
+  m_pool->start(new ParseTask(this, job));
+}
+
+//------------------------------------------------------------------------------
+
+void ResponseWorker::onTaskDone(void* ptr) {
+  Job* job = static_cast<Job*>(ptr);
+  job->done = true;
+
+  // Looked up again each round as the slots connected to parsed() may
+  // queue more responses, or even get here recursively from a nested
+  // event loop.
+  QString key = job->key;
+  for (;;) {
+    QMap<QString, QList<Job*> >::iterator it = m_queues.find(key);
+    if (it == m_queues.end() || !it.value().first()->done)
+      break;
+
+    Job* first = it.value().takeFirst();
+    if (it.value().isEmpty())
+      m_queues.erase(it);
+
+    emit parsed(first->response);
+    delete first;
+  }
+}
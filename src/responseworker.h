@@ -0,0 +1,90 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RESPONSEWORKER_H_
+#define _RESPONSEWORKER_H_
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QVariantMap>
+#include <QThreadPool>
+#include <QMap>
+#include <QList>
+
+#include "json.h"
+
+class RequestTimer;
+
+//------------------------------------------------------------------------------
+
+// A response parsed by ResponseWorker, not modified after parsing.
+struct ParsedResponse {
+  int requestId;
+  int responseId;
+  QString url;
+  RequestTimer* timer;
+
+  QByteArray data;   // cleared once parsed
+  QVariantMap json;
+  JsonFingerprints fingerprints;
+};
+
+//------------------------------------------------------------------------------
+
+/*
+  Parses network responses on a thread pool and hands them back on
+  the worker's own thread with the parsed() signal, so only applying
+  them to the model happens there. Responses with the same ordering
+  key, e.g. pages of the same feed, come out in the order they were
+  queued, others as soon as they are ready.
+*/
+class ResponseWorker : public QObject {
+  Q_OBJECT
+
+public:
+  ResponseWorker(QObject* parent=0);
+  virtual ~ResponseWorker();
+
+  void parse(QString key, const QByteArray& data, int requestId,
+             int responseId, QString url, RequestTimer* timer);
+
+  // True if some responses haven't been handed out by parsed() yet.
+  bool busy() const { return !m_queues.isEmpty(); }
+
+signals:
+  void parsed(const ParsedResponse& response);
+
+private slots:
+  void onTaskDone(void* job);
+
+private:
+  struct Job {
+    QString key;
+    bool done;
+    ParsedResponse response;
+  };
+
+  QThreadPool* m_pool;
+  QMap<QString, QList<Job*> > m_queues;
+
+  friend class ParseTask;
+};
+
+#endif /* _RESPONSEWORKER_H_ */
@@ -18,12 +18,14 @@
 */
 
 #include "richtextlabel.h"
+#include "tracelog.h"
 
 //------------------------------------------------------------------------------
 
 RichTextLabel::RichTextLabel(QWidget* parent, bool singleLine) :
   QLabel(parent),
-  m_singleLine(singleLine)
+  m_singleLine(singleLine),
+  m_overflow(false)
 {
   // useful for debugging layouts and margins
   // setLineWidth(1);
@@ -46,12 +48,59 @@ RichTextLabel::RichTextLabel(QWidget* parent, bool singleLine) :
 
 //------------------------------------------------------------------------------
 
+void RichTextLabel::setText(const QString& text) {
+  if (text == QLabel::text())
+    return;
+
+  clearLayoutCache();
+  QLabel::setText(text);
+}
+
+//------------------------------------------------------------------------------
+
+int RichTextLabel::heightForWidth(int w) const {
+  QHash<int, int>::const_iterator it = m_heightCache.constFind(w);
+  if (it != m_heightCache.constEnd())
+    return it.value();
+
+  // Only a handful of widths are seen between text changes, except
+  // when the window is being resized.
+  if (m_heightCache.count() >= 16)
+    m_heightCache.clear();
+
+  int h = QLabel::heightForWidth(w);
+  m_heightCache.insert(w, h);
+  return h;
+}
+
+//------------------------------------------------------------------------------
+
+void RichTextLabel::changeEvent(QEvent* event) {
+  if (event->type() == QEvent::FontChange ||
+      event->type() == QEvent::StyleChange ||
+      event->type() == QEvent::ContentsRectChange)
+    clearLayoutCache();
+  QLabel::changeEvent(event);
+}
+
+//------------------------------------------------------------------------------
+
 void RichTextLabel::resizeEvent(QResizeEvent*) {
-  if (!m_singleLine && minimumSizeHint().width() > size().width()) {
+  ProfileScope profileScope("RichTextLabel::resizeEvent", "layout");
+
+  // QLabel caches the minimum size hint, but setting the style sheet
+  // throws it away and re-polishes the widget, so only do that when
+  // the overflow state changes.
+  bool overflow = !m_singleLine &&
+    minimumSizeHint().width() > size().width();
+  if (overflow == m_overflow)
+    return;
+  m_overflow = overflow;
+
+  if (overflow) {
     // qDebug() << "[DEBUG]: chop off" << minimumSizeHint().width() << size().width();
     setStyleSheet("border-width: 2px; border-top-style: none; border-right-style: solid; border-bottom-style: none; border-left-style: none; border-color: red; ");
   } else {
     setStyleSheet("");
   }
 }
-
@@ -24,6 +24,7 @@
 #include <QWidget>
 #include <QLabel>
 #include <QVBoxLayout>
+#include <QHash>
 
 #include "qactivitystreams.h"
 #include "filedownloader.h"
@@ -36,10 +37,27 @@ class RichTextLabel : public QLabel {
 public:
   RichTextLabel(QWidget* parent = 0, bool singleLine = false);
 
+  // Hides QLabel::setText(), setting the same text again doesn't
+  // parse the HTML again.
+  void setText(const QString& text);
+
   virtual void resizeEvent(QResizeEvent*);
+  virtual int heightForWidth(int w) const;
+
+protected:
+  virtual void changeEvent(QEvent* event);
 
 private:
+  void clearLayoutCache() { m_heightCache.clear(); }
+
   bool m_singleLine;
+
+  // Whether the text doesn't fit, shown with a red border
+  bool m_overflow;
+
+  // heightForWidth() lays out the text every time, so its results are
+  // kept until the text, font or style changes.
+  mutable QHash<int, int> m_heightCache;
 };
 
 #endif /* _RICHTEXTLABEL_H_ */
@@ -73,11 +73,11 @@ void ShortObjectWidget::changeObject(QASAbstractObject* obj) {
 
   updateAvatar();
 
-  static QSet<QString> expandableTypes;
-  if (expandableTypes.isEmpty())
-    expandableTypes << "person" << "note" << "comment" << "image";
-
-  m_moreButton->setVisible(expandableTypes.contains(m_object->type()));
+  int t = m_object->typeId();
+  m_moreButton->setVisible(t == QASObject::PersonType ||
+                           t == QASObject::NoteType ||
+                           t == QASObject::CommentType ||
+                           t == QASObject::ImageType);
 
   updateText();
 }
@@ -126,8 +126,8 @@ QString ShortObjectWidget::objectExcerpt(QASObject* obj) {
   if (!text.isEmpty()) {
     text.replace(QRegExp(HTML_TAG_REGEX), " ");
   } else {
-    QString t = obj->type();
-    text = (t == "image" ? "an " : "a ") + t;
+    text = (obj->typeId() == QASObject::ImageType ? "an " : "a ") +
+      obj->type();
   }
   return text;
 }
@@ -0,0 +1,177 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "stallwatchdog.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QTime>
+#include <QPair>
+#include <QtAlgorithms>
+#include <QDebug>
+
+//------------------------------------------------------------------------------
+
+#define TICK_INTERVAL 10
+
+// Longer gaps are more likely a suspended machine than a stall
+#define MAX_STALL 60000
+
+#define MAX_RECENT 20
+
+StallWatchdog* StallWatchdog::s_instance = NULL;
+
+//------------------------------------------------------------------------------
+
+StallWatchdog::StallWatchdog(int thresholdMsecs) :
+  m_threshold(thresholdMsecs),
+  m_lastTick(0),
+  m_stalls(0)
+{
+  m_clock.start();
+  connect(&m_timer, SIGNAL(timeout()), this, SLOT(onTick()));
+  m_timer.start(TICK_INTERVAL);
+}
+
+//------------------------------------------------------------------------------
+
+void StallWatchdog::start(int thresholdMsecs) {
+  if (s_instance)
+    return;
+  s_instance = new StallWatchdog(thresholdMsecs);
+  qDebug() << "Reporting GUI stalls longer than" << thresholdMsecs << "ms";
+}
+
+//------------------------------------------------------------------------------
+
+bool StallWatchdog::onGuiThread() {
+  return QThread::currentThread() == s_instance->thread();
+}
+
+//------------------------------------------------------------------------------
+
+void StallWatchdog::enterScope(const char* name) {
+  Frame f;
+  f.name = name;
+  f.start = m_clock.nsecsElapsed();
+  f.children = 0;
+  m_stack.append(f);
+}
+
+//------------------------------------------------------------------------------
+
+void StallWatchdog::leaveScope() {
+  if (m_stack.isEmpty())
+    return;
+
+  Frame f = m_stack.last();
+  m_stack.pop_back();
+
+  qint64 total = m_clock.nsecsElapsed() - f.start;
+  m_window[f.name] += total - f.children;
+  if (!m_stack.isEmpty())
+    m_stack.last().children += total;
+}
+
+//------------------------------------------------------------------------------
+
+void StallWatchdog::onTick() {
+  qint64 now = m_clock.elapsed();
+  qint64 stall = now - m_lastTick - TICK_INTERVAL;
+  m_lastTick = now;
+
+  if (stall >= m_threshold && stall < MAX_STALL) {
+    // Blame the scope with the most own time, and list the runners up
+    QList<QPair<qint64, const char*> > scopes;
+    for (QHash<const char*, qint64>::const_iterator it = m_window.begin();
+         it != m_window.end(); ++it)
+      scopes << qMakePair(it.value(), it.key());
+    qSort(scopes.begin(), scopes.end(),
+          qGreater<QPair<qint64, const char*> >());
+
+    QString blame = "(not instrumented)";
+    if (!scopes.isEmpty() && scopes[0].first >= 1000000)
+      blame = scopes[0].second;
+
+    Stat& s = m_stats[blame];
+    s.count++;
+    s.total += stall;
+    s.max = qMax(s.max, stall);
+    m_stalls++;
+
+    QStringList parts;
+    for (int i=0; i<scopes.size() && i<3; i++)
+      parts << QString("%1 %2 ms").arg(scopes[i].second)
+        .arg(scopes[i].first / 1000000);
+
+    m_recent.prepend(QString("%1 %2 ms  %3").
+                     arg(QTime::currentTime().toString("hh:mm:ss")).
+                     arg(stall, 6).arg(parts.join(", ")));
+    if (m_recent.size() > MAX_RECENT)
+      m_recent.removeLast();
+  }
+
+  m_window.clear();
+}
+
+//------------------------------------------------------------------------------
+
+void StallWatchdog::clear() {
+  if (!s_instance)
+    return;
+  s_instance->m_stats.clear();
+  s_instance->m_recent.clear();
+  s_instance->m_stalls = 0;
+}
+
+//------------------------------------------------------------------------------
+
+QString StallWatchdog::report() {
+  if (!s_instance)
+    return "The stall watchdog is not running, start pumpa with -w 50 to "
+      "report GUI stalls longer than 50 ms.";
+
+  const StallWatchdog* w = s_instance;
+  if (w->m_stalls == 0)
+    return QString("No stalls longer than %1 ms yet.").arg(w->m_threshold);
+
+  QList<QPair<qint64, QString> > ranked;
+  for (QHash<QString, Stat>::const_iterator it = w->m_stats.begin();
+       it != w->m_stats.end(); ++it)
+    ranked << qMakePair(it.value().total, it.key());
+  qSort(ranked.begin(), ranked.end(), qGreater<QPair<qint64, QString> >());
+
+  QStringList lines;
+  lines << QString("%1 stalls longer than %2 ms").arg(w->m_stalls)
+    .arg(w->m_threshold);
+  lines << "";
+  lines << QString("  %1 %2 %3 %4").arg("blamed on", -40).arg("n", 6)
+    .arg("total", 8).arg("max", 8);
+  for (int i=0; i<ranked.size(); i++) {
+    const Stat& s = w->m_stats[ranked[i].second];
+    lines << QString("  %1 %2 %3 %4").arg(ranked[i].second, -40)
+      .arg(s.count, 6).arg(s.total, 8).arg(s.max, 8);
+  }
+
+  lines << "";
+  lines << "Most recent stalls, with the scopes that ran the longest:";
+  lines << w->m_recent;
+
+  return lines.join("\n");
+}
@@ -0,0 +1,101 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _STALLWATCHDOG_H_
+#define _STALLWATCHDOG_H_
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVector>
+#include <QHash>
+
+//------------------------------------------------------------------------------
+
+/*
+  Opt-in detector of GUI freezes. A timer ticks on the GUI thread
+  every few milliseconds, and when a tick comes late by more than the
+  threshold, the event loop was blocked for that long. The stall is
+  blamed on the instrumented scope (see ProfileScope) that used most of
+  its own time, not counting nested scopes, since the previous tick.
+*/
+class StallWatchdog : public QObject {
+  Q_OBJECT
+
+public:
+  static void start(int thresholdMsecs);
+  static bool active() { return s_instance != NULL; }
+
+  // Ranked summary of the stalls seen so far.
+  static QString report();
+  static void clear();
+
+  // Used by ProfileScope, only on the GUI thread
+  static bool onGuiThread();
+  static void enter(const char* name) {
+    if (s_instance)
+      s_instance->enterScope(name);
+  }
+  static void leave() {
+    if (s_instance)
+      s_instance->leaveScope();
+  }
+
+private slots:
+  void onTick();
+
+private:
+  StallWatchdog(int thresholdMsecs);
+
+  void enterScope(const char* name);
+  void leaveScope();
+
+  struct Frame {
+    const char* name;
+    qint64 start;
+    qint64 children;
+  };
+
+  struct Stat {
+    Stat() : count(0), total(0), max(0) {}
+    int count;
+    qint64 total;
+    qint64 max;
+  };
+
+  static StallWatchdog* s_instance;
+
+  int m_threshold;
+  QTimer m_timer;
+  QElapsedTimer m_clock;
+  qint64 m_lastTick;
+
+  QVector<Frame> m_stack;
+
+  // Own time of each scope since the last tick, in nanoseconds
+  QHash<const char*, qint64> m_window;
+
+  QHash<QString, Stat> m_stats;
+  QStringList m_recent;
+  int m_stalls;
+};
+
+#endif /* _STALLWATCHDOG_H_ */
@@ -0,0 +1,174 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tracelog.h"
+
+#include <QCoreApplication>
+#include <QThreadStorage>
+#include <QMutexLocker>
+#include <QDebug>
+
+//------------------------------------------------------------------------------
+
+QFile* TraceLog::s_file = NULL;
+QElapsedTimer TraceLog::s_clock;
+QMutex TraceLog::s_mutex;
+qint64 TraceLog::s_nextId = 0;
+
+//------------------------------------------------------------------------------
+
+static QString jsonString(QString s) {
+  s.replace('\\', "\\\\");
+  s.replace('"', "\\\"");
+  s.replace('\n', "\\n");
+  s.replace('\t', "\\t");
+  return '"' + s + '"';
+}
+
+//------------------------------------------------------------------------------
+
+bool TraceLog::start(QString fileName) {
+  stop();
+
+  QFile* fp = new QFile(fileName);
+  if (!fp->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qDebug() << "[ERROR] unable to open" << fileName << "for writing:"
+             << fp->errorString();
+    delete fp;
+    return false;
+  }
+
+  fp->write("[\n");
+  fp->write(QString("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+                    "\"tid\":1,\"args\":{\"name\":%1}},\n").
+            arg(jsonString(QCoreApplication::applicationName())).toUtf8());
+
+  s_clock.start();
+  s_file = fp;
+
+  qDebug() << "Writing trace events to" << fileName;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+void TraceLog::stop() {
+  QMutexLocker locker(&s_mutex);
+  if (!s_file)
+    return;
+
+  // Ends the array after the trailing comma of the last event
+  s_file->write(QString("{\"name\":\"trace_end\",\"ph\":\"i\",\"s\":\"g\","
+                        "\"ts\":%1,\"pid\":1,\"tid\":1}\n]\n").arg(now()).
+                toUtf8());
+  s_file->close();
+  delete s_file;
+  s_file = NULL;
+}
+
+//------------------------------------------------------------------------------
+
+// Small numbers for the threads in the order they first log
+// something, the GUI thread is 1.
+int TraceLog::threadNumber() {
+  static QThreadStorage<int*> numbers;
+  static int count = 0;
+
+  if (!numbers.hasLocalData()) {
+    int n = ++count;
+    numbers.setLocalData(new int(n));
+
+    QString name = n == 1 ? QString("GUI") : QString("worker %1").arg(n-1);
+    s_file->write(QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                          "\"tid\":%1,\"args\":{\"name\":\"%2\"}},\n").
+                  arg(n).arg(name).toUtf8());
+  }
+  return *numbers.localData();
+}
+
+//------------------------------------------------------------------------------
+
+void TraceLog::write(const char* name, const char* cat, char phase,
+                     QString extra) {
+  qint64 ts = now();
+
+  QMutexLocker locker(&s_mutex);
+  if (!s_file)
+    return;
+
+  int tid = threadNumber();
+  s_file->write(QString("{\"name\":%1,\"cat\":\"%2\",\"ph\":\"%3\","
+                        "\"ts\":%4,\"pid\":1,\"tid\":%5%6},\n").
+                arg(jsonString(name)).arg(cat).arg(phase).arg(ts).arg(tid).
+                arg(extra).toUtf8());
+}
+
+//------------------------------------------------------------------------------
+
+void TraceLog::complete(const char* name, const char* cat, qint64 start,
+                        qint64 duration) {
+  QMutexLocker locker(&s_mutex);
+  if (!s_file)
+    return;
+
+  int tid = threadNumber();
+  s_file->write(QString("{\"name\":%1,\"cat\":\"%2\",\"ph\":\"X\","
+                        "\"ts\":%3,\"dur\":%4,\"pid\":1,\"tid\":%5},\n").
+                arg(jsonString(name)).arg(cat).arg(start).arg(duration).
+                arg(tid).toUtf8());
+}
+
+//------------------------------------------------------------------------------
+
+void TraceLog::begin(const char* name, const char* cat) {
+  write(name, cat, 'B', QString());
+}
+
+//------------------------------------------------------------------------------
+
+void TraceLog::end(const char* name, const char* cat) {
+  write(name, cat, 'E', QString());
+}
+
+//------------------------------------------------------------------------------
+
+void TraceLog::asyncBegin(const char* name, const char* cat, qint64 id,
+                          QString detail) {
+  QString extra = QString(",\"id\":%1").arg(id);
+  if (!detail.isEmpty())
+    extra += QString(",\"args\":{\"detail\":%1}").arg(jsonString(detail));
+  write(name, cat, 'b', extra);
+}
+
+//------------------------------------------------------------------------------
+
+void TraceLog::asyncEnd(const char* name, const char* cat, qint64 id,
+                        QString detail) {
+  QString extra = QString(",\"id\":%1").arg(id);
+  if (!detail.isEmpty())
+    extra += QString(",\"args\":{\"detail\":%1}").arg(jsonString(detail));
+  write(name, cat, 'e', extra);
+}
+
+//------------------------------------------------------------------------------
+
+qint64 TraceLog::nextId() {
+  QMutexLocker locker(&s_mutex);
+  return ++s_nextId;
+}
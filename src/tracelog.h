@@ -0,0 +1,108 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _TRACELOG_H_
+#define _TRACELOG_H_
+
+#include <QString>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QFile>
+
+#include "stallwatchdog.h"
+
+//------------------------------------------------------------------------------
+
+/*
+  Writes events in the Chrome trace-event format, which can be opened
+  in about://tracing or https://ui.perfetto.dev. The file is a JSON
+  array that is written as we go, so it can be loaded even if pumpa
+  doesn't exit cleanly. Timestamps are in microseconds since start().
+*/
+class TraceLog {
+public:
+  static bool start(QString fileName);
+  static void stop();
+  static bool active() { return s_file != NULL; }
+
+  static qint64 now() { return s_clock.nsecsElapsed() / 1000; }
+
+  // A complete ("X") event.
+  static void complete(const char* name, const char* cat, qint64 start,
+                       qint64 duration);
+
+  // Duration ("B" and "E") events, they need to nest on each thread.
+  static void begin(const char* name, const char* cat);
+  static void end(const char* name, const char* cat);
+
+  // Asynchronous ("b" and "e") events, matched by cat and id. Used for
+  // network requests that overlap with everything else.
+  static void asyncBegin(const char* name, const char* cat, qint64 id,
+                         QString detail = QString());
+  static void asyncEnd(const char* name, const char* cat, qint64 id,
+                       QString detail = QString());
+
+  // A new id for asyncBegin().
+  static qint64 nextId();
+
+private:
+  static void write(const char* name, const char* cat, char phase,
+                    QString extra);
+  static int threadNumber();
+
+  static QFile* s_file;
+  static QElapsedTimer s_clock;
+  static QMutex s_mutex;
+  static qint64 s_nextId;
+};
+
+//------------------------------------------------------------------------------
+
+/*
+  Marks a code path for the stall watchdog and the trace log. Costs
+  next to nothing when neither is running.
+*/
+class ProfileScope {
+public:
+  ProfileScope(const char* name, const char* cat = "pumpa") :
+    m_name(name),
+    m_cat(cat),
+    m_stall(StallWatchdog::active() && StallWatchdog::onGuiThread()),
+    m_start(TraceLog::active() ? TraceLog::now() : -1)
+  {
+    if (m_stall)
+      StallWatchdog::enter(name);
+  }
+
+  ~ProfileScope() {
+    if (m_stall)
+      StallWatchdog::leave();
+    if (m_start >= 0)
+      TraceLog::complete(m_name, m_cat, m_start, TraceLog::now() - m_start);
+  }
+
+private:
+  const char* m_name;
+  const char* m_cat;
+  bool m_stall;
+  qint64 m_start;
+};
+
+#endif /* _TRACELOG_H_ */
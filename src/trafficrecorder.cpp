@@ -0,0 +1,140 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "trafficrecorder.h"
+
+#include <QRegExp>
+#include <QTextStream>
+#include <QDebug>
+
+//------------------------------------------------------------------------------
+
+#define SECRET_KEYS \
+  "(oauth_token|oauth_token_secret|oauth_signature|oauth_verifier|" \
+  "client_secret)"
+
+const char* TrafficRecorder::IndexFile = "index.txt";
+
+QFile* TrafficRecorder::s_index = NULL;
+QDir TrafficRecorder::s_dir;
+int TrafficRecorder::s_counter = 0;
+
+//------------------------------------------------------------------------------
+
+bool TrafficRecorder::start(QString dirName) {
+  stop();
+
+  QDir dir(dirName);
+  if (!dir.exists() && !dir.mkpath(".")) {
+    qDebug() << "[ERROR] unable to create directory" << dirName;
+    return false;
+  }
+
+  // Continue numbering after an earlier recording in the same place,
+  // there is one line in the index for each number used.
+  s_counter = 0;
+  QFile old(dir.filePath(IndexFile));
+  if (old.open(QIODevice::ReadOnly | QIODevice::Text))
+    while (!old.atEnd())
+      if (!old.readLine().startsWith('#'))
+        s_counter++;
+
+  QFile* fp = new QFile(dir.filePath(IndexFile));
+  if (!fp->open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+    qDebug() << "[ERROR] unable to open" << fp->fileName() << "for writing:"
+             << fp->errorString();
+    delete fp;
+    return false;
+  }
+
+  if (fp->size() == 0)
+    fp->write("# file\tresponse_id\tmethod\terror\tbytes\tmsecs\t"
+              "endpoint\n");
+
+  s_dir = dir;
+  s_index = fp;
+
+  qDebug() << "Recording traffic to" << dir.absolutePath();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+void TrafficRecorder::stop() {
+  if (!s_index)
+    return;
+  s_index->close();
+  delete s_index;
+  s_index = NULL;
+}
+
+//------------------------------------------------------------------------------
+
+QString TrafficRecorder::redact(QString text) {
+  static QRegExp rxParam(SECRET_KEYS "=[^&\\s\"]*");
+  static QRegExp rxJson("\"" SECRET_KEYS "\"\\s*:\\s*\"[^\"]*\"");
+
+  text.replace(rxParam, "\\1=REDACTED");
+  text.replace(rxJson, "\"\\1\":\"REDACTED\"");
+  return text;
+}
+
+//------------------------------------------------------------------------------
+
+QString TrafficRecorder::writeFile(QString fileName, const QByteArray& data) {
+  QFile fp(s_dir.filePath(fileName));
+  if (!fp.open(QIODevice::WriteOnly)) {
+    qDebug() << "[ERROR] unable to write" << fp.fileName();
+    return "-";
+  }
+  fp.write(data);
+  return fileName;
+}
+
+//------------------------------------------------------------------------------
+
+void TrafficRecorder::record(QString method, QString endpoint, int responseId,
+                             int error, const QByteArray& response,
+                             qint64 msecs, const QByteArray& requestData,
+                             bool isJson) {
+  if (!s_index)
+    return;
+
+  QString base = QString("%1").arg(s_counter++, 6, 10, QChar('0'));
+
+  // Only touch bodies that might contain something secret, the rest
+  // are saved byte for byte.
+  QByteArray body = response;
+  if (isJson && (body.contains("oauth_") || body.contains("client_secret")))
+    body = redact(QString::fromUtf8(body)).toUtf8();
+
+  QString fileName = "-";
+  if (!body.isEmpty())
+    fileName = writeFile(base + (isJson ? ".json" : ".data"), body);
+
+  if (!requestData.isEmpty())
+    writeFile(base + ".request.json",
+              redact(QString::fromUtf8(requestData)).toUtf8());
+
+  QTextStream out(s_index);
+  out << fileName << '\t' << responseId << '\t' << method << '\t'
+      << error << '\t' << response.size() << '\t' << msecs << '\t'
+      << redact(endpoint) << '\n';
+  out.flush();
+}
@@ -0,0 +1,68 @@
+/*
+  Copyright 2013 Mats Sjöberg
+
+  This file is part of the Pumpa programme.
+
+  Pumpa is free software: you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Pumpa is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Pumpa.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _TRAFFICRECORDER_H_
+#define _TRAFFICRECORDER_H_
+
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+#include <QDir>
+
+//------------------------------------------------------------------------------
+
+/*
+  Saves every response pumpa receives to a directory, for replaying
+  later with pumpa-bench. Each response body is written to its own
+  numbered file, and a line is added to index.txt with the tab
+  separated fields:
+
+    file  response_id  method  error  bytes  msecs  endpoint
+
+  where file is "-" if there was no body. Request bodies of POSTs are
+  saved next to the response as NNNNNN.request.json. OAuth tokens,
+  signatures and client secrets are replaced by "REDACTED" in the
+  endpoints and JSON bodies.
+*/
+class TrafficRecorder {
+public:
+  static const char* IndexFile;
+
+  // Starts recording to dirName, which is created if needed.
+  static bool start(QString dirName);
+  static void stop();
+
+  static bool active() { return s_index != NULL; }
+
+  static void record(QString method, QString endpoint, int responseId,
+                     int error, const QByteArray& response, qint64 msecs,
+                     const QByteArray& requestData = QByteArray(),
+                     bool isJson = true);
+
+  static QString redact(QString text);
+
+private:
+  static QString writeFile(QString fileName, const QByteArray& data);
+
+  static QFile* s_index;
+  static QDir s_dir;
+  static int s_counter;
+};
+
+#endif /* _TRAFFICRECORDER_H_ */
@@ -25,6 +25,7 @@
 #include <QObject>
 #include <QDebug>
 #include <QFile>
+#include <QHash>
 
 #ifdef DEBUG_MEMORY
 #include <sys/resource.h>
@@ -160,6 +161,170 @@ bool splitWebfingerId(QString accountId, QString& username, QString& server) {
 
 //------------------------------------------------------------------------------
 
+static inline int parseDigits(const QChar* p, int n, bool& ok) {
+  int v = 0;
+  for (int i=0; i<n; i++) {
+    ushort c = p[i].unicode();
+    if (c < '0' || c > '9')
+      ok = false;
+    v = v*10 + (c - '0');
+  }
+  return v;
+}
+
+//------------------------------------------------------------------------------
+
+// Days from 1970-01-01 to the given date in the proleptic Gregorian
+// calendar.
+static qint64 daysFromCivil(int y, int m, int d) {
+  y -= m <= 2;
+  const int era = (y >= 0 ? y : y-399) / 400;
+  const int yoe = y - era*400;
+  const int doy = (153*(m + (m > 2 ? -3 : 9)) + 2)/5 + d-1;
+  const int doe = yoe*365 + yoe/4 - yoe/100 + doy;
+  return qint64(era)*146097 + doe - 719468;
+}
+
+//------------------------------------------------------------------------------
+
+static bool parseIsoTimeFast(const QString& timeStr, qint64& msecs) {
+  // 2013-05-28T16:43:06Z or 2013-05-28T16:43:06.123Z
+  const int len = timeStr.size();
+  if (len < 20)
+    return false;
+
+  const QChar* p = timeStr.constData();
+  if (p[4] != '-' || p[7] != '-' || p[10] != 'T' || p[13] != ':' ||
+      p[16] != ':' || p[len-1] != 'Z')
+    return false;
+
+  bool ok = true;
+  int year = parseDigits(p, 4, ok);
+  int month = parseDigits(p+5, 2, ok);
+  int day = parseDigits(p+8, 2, ok);
+  int hour = parseDigits(p+11, 2, ok);
+  int minute = parseDigits(p+14, 2, ok);
+  int second = parseDigits(p+17, 2, ok);
+
+  int ms = 0;
+  if (len > 20) {
+    // fraction of a second, only the first three digits matter
+    int nfrac = len-21;
+    if (p[19] != '.' || nfrac < 1 || nfrac > 9)
+      return false;
+    parseDigits(p+20, nfrac, ok);
+    ms = parseDigits(p+20, qMin(nfrac, 3), ok);
+    for (int i=nfrac; i<3; i++)
+      ms *= 10;
+  }
+
+  if (!ok || month < 1 || month > 12 || day < 1 || hour > 23 ||
+      minute > 59 || second > 59)
+    return false;
+
+  static const int mdays[] = { 31,28,31,30,31,30,31,31,30,31,30,31 };
+  bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+  if (day > mdays[month-1] + (month == 2 && leap ? 1 : 0))
+    return false;
+
+  msecs = ((daysFromCivil(year, month, day)*24 + hour)*60 + minute)*60 +
+    second;
+  msecs = msecs*1000 + ms;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+qint64 parseIsoTime(const QString& timeStr, bool* ok) {
+  qint64 msecs = 0;
+  if (parseIsoTimeFast(timeStr, msecs)) {
+    if (ok) *ok = true;
+    return msecs;
+  }
+
+  // Qt 5 takes 24:00 as midnight of the next day, pump.io never sends
+  // that and the fast path doesn't accept it either.
+  if (timeStr.mid(10, 3) == "T24") {
+    if (ok) *ok = false;
+    return 0;
+  }
+
+  // Anything else is rare, but remember the results so that the same
+  // odd string doesn't get parsed over and over again.
+  static QHash<QString, qint64> cache;
+  static const qint64 invalidTime = Q_INT64_C(0x8000000000000000);
+
+  QHash<QString, qint64>::const_iterator it = cache.constFind(timeStr);
+  if (it != cache.constEnd()) {
+    msecs = it.value();
+  } else {
+    QDateTime dt = QDateTime::fromString(timeStr, Qt::ISODate);
+    dt.setTimeSpec(Qt::UTC);
+    msecs = dt.isValid() ? dt.toMSecsSinceEpoch() : invalidTime;
+
+    if (cache.size() >= 1024)
+      cache.clear();
+    cache.insert(timeStr, msecs);
+  }
+
+  if (ok) *ok = (msecs != invalidTime);
+  return msecs == invalidTime ? 0 : msecs;
+}
+
+//------------------------------------------------------------------------------
+
+static QHash<QString, QString> s_imageUrlAliases;
+
+void addImageUrlAlias(const QString& proxyUrl, const QString& url) {
+  if (!proxyUrl.isEmpty() && !url.isEmpty() && proxyUrl != url)
+    s_imageUrlAliases.insert(proxyUrl, url);
+}
+
+//------------------------------------------------------------------------------
+
+int imageUrlAliasCount() {
+  return s_imageUrlAliases.count();
+}
+
+//------------------------------------------------------------------------------
+
+QString canonicalImageUrl(const QString& url) {
+  QString ret = s_imageUrlAliases.value(url, url);
+
+  int pos = ret.indexOf('#');
+  if (pos >= 0)
+    ret.truncate(pos);
+
+  QString query;
+  pos = ret.indexOf('?');
+  if (pos >= 0) {
+    query = ret.mid(pos+1);
+    ret.truncate(pos);
+  }
+
+  pos = ret.indexOf("://");
+  if (pos >= 0) {
+    int hostEnd = ret.indexOf('/', pos+3);
+    if (hostEnd < 0)
+      hostEnd = ret.length();
+    QString origin = ret.left(hostEnd).toLower();
+    if (origin.startsWith("http://") && origin.endsWith(":80"))
+      origin.chop(3);
+    else if (origin.startsWith("https://") && origin.endsWith(":443"))
+      origin.chop(4);
+    ret.replace(0, hostEnd, origin);
+  }
+
+  if (!query.isEmpty()) {
+    QStringList items = query.split('&', QString::SkipEmptyParts);
+    items.sort();
+    ret += "?" + items.join("&");
+  }
+  return ret;
+}
+
+//------------------------------------------------------------------------------
+
 long getMaxRSS() {
 #ifdef DEBUG_MEMORY
   struct rusage rusage;
@@ -66,6 +66,26 @@ QString relativeFuzzyTime(QDateTime sTime);
 
 bool splitWebfingerId(QString accountId, QString& username, QString& server);
 
+/*
+  Parses an ISO 8601 UTC timestamp to milliseconds since the epoch.
+  The "yyyy-MM-ddThh:mm:ss(.sss)Z" format used by pump.io is handled
+  directly, anything else goes through QDateTime::fromString. Sets
+  *ok to false if the string could not be parsed.
+*/
+qint64 parseIsoTime(const QString& timeStr, bool* ok=0);
+
+/*
+  Images are referred to both by their own URL and by the pump.io
+  proxy URL on the user's server, which can't be told apart from the
+  URL alone. addImageUrlAlias() records that proxyUrl is the same
+  image as url, and canonicalImageUrl() maps known aliases to the
+  original URL, with the scheme and host in lower case, default ports
+  and fragments removed and the query parameters sorted.
+*/
+void addImageUrlAlias(const QString& proxyUrl, const QString& url);
+QString canonicalImageUrl(const QString& url);
+int imageUrlAliasCount();
+
 template <class T> void deleteMap(QMap<QString, T>& map) {
   typename QMap<QString, T>::iterator i;
   for (i = map.begin(); i != map.end(); ++i)
@@ -73,6 +93,30 @@ template <class T> void deleteMap(QMap<QString, T>& map) {
   map.clear();
 }
 
+/*
+  Rough estimates of heap memory use, for the memory page of the
+  diagnostics dialog. mapMemoryUsage() counts the keys, the map nodes
+  and the objects' own memoryUsage().
+*/
+inline qint64 stringBytes(const QString& s) {
+  return s.capacity() * sizeof(QChar);
+}
+
+template <class T> qint64 mapMemoryUsage(const QMap<QString, T>& map) {
+  qint64 bytes = 0;
+  typename QMap<QString, T>::const_iterator i;
+  for (i = map.begin(); i != map.end(); ++i)
+    bytes += 4*sizeof(void*) + stringBytes(i.key()) + i.value()->memoryUsage();
+  return bytes;
+}
+
+/*
+  Peak resident set size in KB and current resident set size in
+  bytes. Both return 0 unless built with DEBUG_MEMORY.
+*/
+long getMaxRSS();
+long getCurrentRSS();
+
 void checkMemory(QString desc="");
 
 //------------------------------------------------------------------------------